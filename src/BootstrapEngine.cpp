@@ -0,0 +1,136 @@
+#include "BootstrapEngine.h"
+#include "RunningMoments.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+    /**
+     * Maps a 64-bit random value onto [0, range) by multiply-shift, without a division.
+     */
+    inline uint32_t bounded(uint64_t random, uint32_t range)
+    {
+        return static_cast<uint32_t>(((random >> 32) * range) >> 32);
+    }
+
+    /**
+     * Selects the median the same way Util_fn::vector_median does.
+     */
+    inline double select_median(std::vector<double>& values)
+    {
+        size_t n = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + n, values.end());
+        return values[n];
+    }
+}
+
+/**
+ * @param pool       Workers to spread the resamples across; must outlive this engine
+ * @param resamples  Number of resamples per run
+ * @param confidence Confidence level of the intervals, in (0, 1)
+ * @param seed       Seed of the generator; equal seeds give equal intervals
+ */
+BootstrapEngine::BootstrapEngine(ThreadPool& pool, int resamples, double confidence, uint64_t seed)
+    : m_pool(pool), m_resamples(resamples), m_confidence(confidence), m_seed(seed), m_scratch(pool.size()),
+      m_kepler_means(resamples), m_kepler_medians(resamples), m_sec_means(resamples), m_sec_medians(resamples),
+      m_slopes(resamples)
+{
+}
+
+/**
+ * Draws resample resample_id and stores its statistics in slot resample_id.
+ */
+void BootstrapEngine::resample(const bootstrap_sample_t& sample, size_t resample_id, worker_scratch_t& scratch)
+{
+    uint32_t count = static_cast<uint32_t>(sample.count);
+    uint64_t stream = Util_fn::counter_random(m_seed, resample_id);
+
+    // resize() only allocates while a worker's buffers are still growing.
+    scratch.draws.resize(count);
+    scratch.kepler.resize(count);
+    scratch.secondary.resize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+        scratch.draws[i] = bounded(Util_fn::counter_random(stream, i), count);
+
+    Util_fn::running_moments_t kepler, secondary;
+    Util_fn::running_regression_t regression;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t row = scratch.draws[i];
+
+        scratch.kepler[i] = sample.kepler_mass[row];
+        scratch.secondary[i] = sample.secondary_mass[row];
+        kepler.add(sample.kepler_mass[row]);
+        secondary.add(sample.secondary_mass[row]);
+        regression.add(sample.kepler_x[row], sample.kepler_y[row]);
+    }
+
+    m_kepler_means[resample_id] = kepler.mean();
+    m_sec_means[resample_id] = secondary.mean();
+    m_slopes[resample_id] = regression.slope();
+    m_kepler_medians[resample_id] = select_median(scratch.kepler);
+    m_sec_medians[resample_id] = select_median(scratch.secondary);
+}
+
+/**
+ * Reads the percentile interval off the statistics of every resample (reorders them).
+ *
+ * Resamples whose statistic is undefined -- a regression over one repeated x value has no slope --
+ * are set aside first, as NaN does not order. The interval is NaN when they outnumber the
+ * 1 - confidence share of the resamples that the interval may leave out anyway.
+ */
+confidence_interval_t BootstrapEngine::interval(std::vector<double>& statistics) const
+{
+    auto finite_end = std::partition(statistics.begin(), statistics.end(), [](double value) { return !std::isnan(value); });
+    size_t finite = static_cast<size_t>(finite_end - statistics.begin());
+    size_t undefined = statistics.size() - finite;
+
+    if (finite == 0 || static_cast<double>(undefined) > (1 - m_confidence) * static_cast<double>(statistics.size()))
+        return {NOT_A_NUMBER, NOT_A_NUMBER};
+
+    double tail = (1 - m_confidence) / 2;
+    double last = static_cast<double>(finite - 1);
+    auto low = statistics.begin() + static_cast<std::ptrdiff_t>(tail * last + 0.5);
+    auto high = statistics.begin() + static_cast<std::ptrdiff_t>((1 - tail) * last + 0.5);
+
+    std::nth_element(statistics.begin(), low, finite_end);
+    double low_value = *low;
+    std::nth_element(low, high, finite_end);
+
+    return {low_value, *high};
+}
+
+/**
+ * Bootstraps the sample.
+ *
+ * @return The intervals; NaN when the sample is empty or no resamples are configured
+ */
+ecm_bootstrap_t BootstrapEngine::run(const bootstrap_sample_t& sample)
+{
+    if (sample.count == 0 || m_resamples <= 0)
+    {
+        confidence_interval_t none {NOT_A_NUMBER, NOT_A_NUMBER};
+        return {none, none, none, none, none};
+    }
+
+    size_t resamples = static_cast<size_t>(m_resamples);
+    size_t block_count = std::min(resamples, static_cast<size_t>(m_pool.size()) * 4);
+    size_t block_size = (resamples + block_count - 1) / block_count;
+
+    m_pool.parallel_for(block_count, [&](size_t block, unsigned worker) {
+        size_t end = std::min(resamples, (block + 1) * block_size);
+
+        for (size_t r = block * block_size; r < end; ++r)
+            resample(sample, r, m_scratch[worker]);
+    });
+
+    return {
+            interval(m_kepler_means), interval(m_kepler_medians), interval(m_sec_means), interval(m_sec_medians),
+            interval(m_slopes)
+    };
+}
@@ -0,0 +1,81 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_BOOTSTRAPENGINE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_BOOTSTRAPENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+ * The qualified satellites to resample: four parallel arrays of count values each.
+ */
+struct bootstrap_sample_t {
+    const double* kepler_mass;
+    const double* secondary_mass;
+    const double* kepler_x;
+    const double* kepler_y;
+    size_t count;
+};
+
+/**
+ * A percentile confidence interval.
+ */
+struct confidence_interval_t {
+    double low;
+    double high;
+};
+
+/**
+ * Confidence intervals of one bootstrap run.
+ */
+struct ecm_bootstrap_t {
+    confidence_interval_t kepler_mean;
+    confidence_interval_t kepler_median;
+    confidence_interval_t sec_mean;
+    confidence_interval_t sec_median;
+    confidence_interval_t regression_slope; /*!< Slope of kepler_y against kepler_x */
+};
+
+/**
+ * Percentile bootstrap of the mean and median of both mass estimates and of the Kepler regression
+ * slope. Every resample draws count satellites with replacement, computes the statistics of its
+ * draw, and the intervals are read off the sorted statistics of all resamples.
+ *
+ * Resamples are spread across the pool. Every draw is a Util_fn::counter_random value indexed by
+ * (seed, resample, draw) -- a counter-based generator rather than a stateful one -- so every
+ * resample draws the same satellites whichever worker runs it, and the intervals do not depend
+ * on the thread count.
+ * The index and median buffers of every worker are kept between runs and only grow, so once
+ * they have reached the largest sample size, running the bootstrap allocates nothing.
+ */
+class BootstrapEngine
+{
+private:
+    /**
+     * Buffers one worker reuses for every resample it runs.
+     */
+    struct worker_scratch_t {
+        std::vector<uint32_t> draws;
+        std::vector<double> kepler;
+        std::vector<double> secondary;
+    };
+
+    ThreadPool& m_pool; /*!< Workers the resamples are spread across */
+    int m_resamples; /*!< Resamples per run */
+    double m_confidence; /*!< Confidence level of the intervals, e.g. 0.95 */
+    uint64_t m_seed; /*!< Seed of the counter-based generator */
+
+    std::vector<worker_scratch_t> m_scratch; /*!< One per pool worker */
+    std::vector<double> m_kepler_means, m_kepler_medians; /*!< Statistic of every resample */
+    std::vector<double> m_sec_means, m_sec_medians; /*!< Statistic of every resample */
+    std::vector<double> m_slopes; /*!< Statistic of every resample */
+
+    void resample(const bootstrap_sample_t& sample, size_t resample_id, worker_scratch_t& scratch);
+    confidence_interval_t interval(std::vector<double>& statistics) const;
+public:
+    BootstrapEngine(ThreadPool& pool, int resamples, double confidence, uint64_t seed);
+
+    ecm_bootstrap_t run(const bootstrap_sample_t& sample);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_BOOTSTRAPENGINE_H
@@ -0,0 +1,134 @@
+#include "FusedAnalysisEngine.h"
+#include "KeplerKernels.h"
+#include "MEQSweepEngine.h"
+#include "Settings.h"
+#include <algorithm>
+
+namespace
+{
+    // Layout of FusedAnalysisEngine::m_block, in blocks of SELECTION_GATHER_ROWS values.
+    enum block_slot_t {
+        SLOT_PERIGEE, SLOT_APOGEE, SLOT_PERIOD,
+        SLOT_KEPLER_X, SLOT_KEPLER_Y, SLOT_KEPLER_MASS, SLOT_VELOCITY, SLOT_SECONDARY_MASS, SLOT_COUNT
+    };
+}
+
+/**
+ * @param sketch_k Size parameter (error bound) of the quantile sketches, see QuantileSketch
+ */
+FusedAnalysisEngine::FusedAnalysisEngine(size_t sketch_k)
+    : m_block(SLOT_COUNT * SELECTION_GATHER_ROWS), m_kepler_sketch(sketch_k), m_secondary_sketch(sketch_k)
+{
+}
+
+/**
+ * Analyzes the listed rows in one pass (see the class description).
+ *
+ * @param columns         Store holding the rows; its result columns are filled for them
+ * @param rows            Selection vector of the qualifying rows
+ * @param row_count       Number of rows in the selection vector
+ * @param output          Receives one "x,y,mass_estimation_kepler,mass_estimation_secondary" row per selected row (nullptr for none)
+ * @param snapshot_labels If not nullptr, every output row starts with the label of its snapshot (already a csv field)
+ */
+void FusedAnalysisEngine::add(UCSSatelliteColumns& columns, const uint32_t* rows, size_t row_count, std::ostream* output,
+                              const std::vector<std::string>* snapshot_labels)
+{
+    double* slot[SLOT_COUNT];
+
+    for (int i = 0; i < SLOT_COUNT; ++i)
+        slot[i] = m_block.data() + i * SELECTION_GATHER_ROWS;
+
+    for (size_t first = 0; first < row_count; first += SELECTION_GATHER_ROWS)
+    {
+        size_t count = std::min(SELECTION_GATHER_ROWS, row_count - first);
+        const uint32_t* block_rows = rows + first;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            slot[SLOT_PERIGEE][i] = columns.perigee[block_rows[i]];
+            slot[SLOT_APOGEE][i] = columns.apogee[block_rows[i]];
+            slot[SLOT_PERIOD][i] = columns.period[block_rows[i]];
+        }
+
+        kepler_batch_t batch = {
+                slot[SLOT_PERIGEE], slot[SLOT_APOGEE], slot[SLOT_PERIOD], slot[SLOT_KEPLER_X], slot[SLOT_KEPLER_Y],
+                slot[SLOT_KEPLER_MASS], slot[SLOT_VELOCITY], slot[SLOT_SECONDARY_MASS], count
+        };
+
+        Kepler_fn::compute(batch);
+
+        m_kepler_moments.merge(Util_fn::moments_of(slot[SLOT_KEPLER_MASS], count));
+        m_secondary_moments.merge(Util_fn::moments_of(slot[SLOT_SECONDARY_MASS], count));
+        m_regression.merge(Util_fn::regression_of(slot[SLOT_KEPLER_X], slot[SLOT_KEPLER_Y], count));
+        m_kepler_sketch.add(slot[SLOT_KEPLER_MASS], count);
+        m_secondary_sketch.add(slot[SLOT_SECONDARY_MASS], count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t row = block_rows[i];
+            double kepler_mass = slot[SLOT_KEPLER_MASS][i];
+            double secondary_mass = slot[SLOT_SECONDARY_MASS][i];
+
+            columns.kepler_x[row] = slot[SLOT_KEPLER_X][i];
+            columns.kepler_y[row] = slot[SLOT_KEPLER_Y][i];
+            columns.kepler_mass[row] = kepler_mass;
+            columns.satellite_velocity[row] = slot[SLOT_VELOCITY][i];
+            columns.secondary_mass[row] = secondary_mass;
+
+            if (!output)
+                continue;
+
+            if (snapshot_labels)
+                *output << (*snapshot_labels)[columns.snapshot_id[row]] << ",";
+
+            *output << slot[SLOT_KEPLER_X][i] << "," << slot[SLOT_KEPLER_Y][i] << "," << kepler_mass << "," << secondary_mass << '\n';
+        }
+    }
+}
+
+/**
+ * Folds in everything other has analyzed, as if its rows had been added to this engine.
+ */
+void FusedAnalysisEngine::merge(const FusedAnalysisEngine& other)
+{
+    m_kepler_moments.merge(other.m_kepler_moments);
+    m_secondary_moments.merge(other.m_secondary_moments);
+    m_regression.merge(other.m_regression);
+    m_kepler_sketch.merge(other.m_kepler_sketch);
+    m_secondary_sketch.merge(other.m_secondary_sketch);
+}
+
+/**
+ * Forgets every row added so far; the block buffer is kept for reuse.
+ */
+void FusedAnalysisEngine::clear()
+{
+    m_kepler_moments.clear();
+    m_secondary_moments.clear();
+    m_regression.clear();
+    m_kepler_sketch.clear();
+    m_secondary_sketch.clear();
+}
+
+/**
+ * Derives the analysis of every row added so far. The medians come from the quantile sketches,
+ * so past QUANTILE_SKETCH_K rows they are approximate (see QuantileSketch).
+ *
+ * @param qualifier       Eccentricity qualifier the rows were selected with
+ * @param satellite_count Number of rows the selection was taken from, qualifying or not
+ */
+ecm_analysis_t FusedAnalysisEngine::result(double qualifier, int satellite_count) const
+{
+    return MEQSweepEngine::make_analysis(qualifier, m_kepler_moments.mean(), m_kepler_sketch.quantile(0.5), m_kepler_moments.standard_deviation(),
+                                         m_secondary_moments.mean(), m_secondary_sketch.quantile(0.5), m_secondary_moments.standard_deviation(),
+                                         satellite_count - get_qualified_count(), m_regression);
+}
+
+/**
+ * Looks up the REPORTED_QUANTILES of both mass estimations in the sketches.
+ */
+void FusedAnalysisEngine::percentiles(mass_percentiles_t& percentiles) const
+{
+    m_kepler_sketch.quantiles(REPORTED_QUANTILES, REPORTED_QUANTILE_COUNT, percentiles.kepler);
+    m_secondary_sketch.quantiles(REPORTED_QUANTILES, REPORTED_QUANTILE_COUNT, percentiles.secondary);
+}
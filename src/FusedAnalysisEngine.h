@@ -0,0 +1,54 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_FUSEDANALYSISENGINE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_FUSEDANALYSISENGINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "QuantileSketch.h"
+#include "RunningMoments.h"
+#include "Settings.h"
+#include "UCSSatelliteColumns.h"
+#include "ecm_analysis_t.h"
+
+/**
+ * The REPORTED_QUANTILES of both mass estimations.
+ */
+struct mass_percentiles_t {
+    double kepler[REPORTED_QUANTILE_COUNT];
+    double secondary[REPORTED_QUANTILE_COUNT];
+};
+
+/**
+ * Non-MEQ analysis in a single pass over the selected rows. The rows are processed in blocks of
+ * SELECTION_GATHER_ROWS: their inputs are gathered, the Kepler / secondary-method batch kernel
+ * runs over the block, and while the block's results are still in cache they are written back
+ * to the result columns, folded into the running moments and quantile sketches of both methods
+ * and the Kepler regression and, if asked for, written out as CSV rows.
+ *
+ * The accumulators carry over from one add() to the next, so a stream of batches can be analyzed
+ * piece by piece, and engines that analyzed separate shards can be merged.
+ */
+class FusedAnalysisEngine
+{
+private:
+    aligned_vector<double> m_block; /*!< Gathered inputs and kernel outputs of one block */
+    Util_fn::running_moments_t m_kepler_moments; /*!< Moments of every Kepler mass added so far */
+    Util_fn::running_moments_t m_secondary_moments; /*!< Moments of every secondary mass added so far */
+    Util_fn::running_regression_t m_regression; /*!< Least-squares fit of every Kepler (x, y) point added so far */
+    QuantileSketch m_kepler_sketch; /*!< Quantiles of every Kepler mass added so far */
+    QuantileSketch m_secondary_sketch; /*!< Quantiles of every secondary mass added so far */
+public:
+    explicit FusedAnalysisEngine(size_t sketch_k = QUANTILE_SKETCH_K);
+
+    void add(UCSSatelliteColumns& columns, const uint32_t* rows, size_t row_count, std::ostream* output,
+             const std::vector<std::string>* snapshot_labels = nullptr);
+    void merge(const FusedAnalysisEngine& other);
+    void clear();
+    ecm_analysis_t result(double qualifier, int satellite_count) const;
+    void percentiles(mass_percentiles_t& percentiles) const;
+
+    inline int get_qualified_count() const { return static_cast<int>(m_kepler_moments.count); };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_FUSEDANALYSISENGINE_H
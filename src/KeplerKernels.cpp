@@ -0,0 +1,233 @@
+#include "KeplerKernels.h"
+#include "Settings.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KEPLER_KERNELS_X86 1
+#endif
+
+namespace
+{
+    /* The constants are built with the exact expressions of the original per-satellite code so
+     * that they carry the same bits. */
+    const double PI = 2.0 * acos(0.0);
+    const double FOUR_PI_SQUARED = 4.0 * pow(PI, 2);
+    const double TWO_PI_CIRCUMFERENCE = 2 * 3.1415926535;
+
+    kernel_isa_t g_active_isa = Kepler_fn::detect_isa();
+
+    /**
+     * Reference implementation. The SIMD versions below perform the exact same operations
+     * in the exact same order, one lane per satellite.
+     *
+     * The kepler_x and kepler_y pairs are calculated from a generalization of Kepler's 3rd law;
+     * the mass of the Earth can be estimated by taking the slope of a regression of these
+     * coordinates. kepler_mass rearranges Kepler's 3rd law to solve for the Earth's mass directly,
+     * and has to be averaged over all satellites afterwards.
+     *
+     * The secondary method first estimates the orbital velocity as the average orbital
+     * circumference over the period, then uses (attractive force) = (centripetal force):
+     *                                       M = (Rv^2) / G
+     * where R is the satellite's distance from the Earth's centre.
+     */
+    void compute_scalar(const kepler_batch_t& b, size_t begin)
+    {
+        for (size_t i = begin; i < b.count; ++i)
+        {
+            double half_sum = (b.apogee[i] + b.perigee[i]) * 0.5;
+            double r_value = half_sum + RADIUS_OF_THE_EARTH;
+            double numerator = FOUR_PI_SQUARED * (r_value * r_value * r_value);
+            double period_squared = b.period[i] * b.period[i];
+            double velocity = (TWO_PI_CIRCUMFERENCE * half_sum) / b.period[i];
+
+            b.kepler_x[i] = numerator / GRAVITATIONAL_CONSTANT;
+            b.kepler_y[i] = period_squared;
+            b.kepler_mass[i] = numerator / (period_squared * GRAVITATIONAL_CONSTANT);
+            b.satellite_velocity[i] = velocity;
+            b.secondary_mass[i] = (RADIUS_OF_THE_EARTH + half_sum) * (velocity * velocity) / GRAVITATIONAL_CONSTANT;
+        }
+    }
+
+#ifdef KEPLER_KERNELS_X86
+    __attribute__((target("sse2")))
+    void compute_sse2(const kepler_batch_t& b)
+    {
+        const __m128d half = _mm_set1_pd(0.5);
+        const __m128d radius = _mm_set1_pd(RADIUS_OF_THE_EARTH);
+        const __m128d four_pi_squared = _mm_set1_pd(FOUR_PI_SQUARED);
+        const __m128d circumference = _mm_set1_pd(TWO_PI_CIRCUMFERENCE);
+        const __m128d g = _mm_set1_pd(GRAVITATIONAL_CONSTANT);
+
+        size_t i = 0;
+
+        for (; i + 2 <= b.count; i += 2)
+        {
+            __m128d period = _mm_loadu_pd(b.period + i);
+            __m128d half_sum = _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(b.apogee + i), _mm_loadu_pd(b.perigee + i)), half);
+            __m128d r_value = _mm_add_pd(half_sum, radius);
+            __m128d numerator = _mm_mul_pd(four_pi_squared, _mm_mul_pd(_mm_mul_pd(r_value, r_value), r_value));
+            __m128d period_squared = _mm_mul_pd(period, period);
+            __m128d velocity = _mm_div_pd(_mm_mul_pd(circumference, half_sum), period);
+
+            _mm_storeu_pd(b.kepler_x + i, _mm_div_pd(numerator, g));
+            _mm_storeu_pd(b.kepler_y + i, period_squared);
+            _mm_storeu_pd(b.kepler_mass + i, _mm_div_pd(numerator, _mm_mul_pd(period_squared, g)));
+            _mm_storeu_pd(b.satellite_velocity + i, velocity);
+            _mm_storeu_pd(b.secondary_mass + i, _mm_div_pd(_mm_mul_pd(_mm_add_pd(radius, half_sum), _mm_mul_pd(velocity, velocity)), g));
+        }
+
+        compute_scalar(b, i);
+    }
+
+    __attribute__((target("avx2")))
+    void compute_avx2(const kepler_batch_t& b)
+    {
+        const __m256d half = _mm256_set1_pd(0.5);
+        const __m256d radius = _mm256_set1_pd(RADIUS_OF_THE_EARTH);
+        const __m256d four_pi_squared = _mm256_set1_pd(FOUR_PI_SQUARED);
+        const __m256d circumference = _mm256_set1_pd(TWO_PI_CIRCUMFERENCE);
+        const __m256d g = _mm256_set1_pd(GRAVITATIONAL_CONSTANT);
+
+        size_t i = 0;
+
+        for (; i + 4 <= b.count; i += 4)
+        {
+            __m256d period = _mm256_loadu_pd(b.period + i);
+            __m256d half_sum = _mm256_mul_pd(_mm256_add_pd(_mm256_loadu_pd(b.apogee + i), _mm256_loadu_pd(b.perigee + i)), half);
+            __m256d r_value = _mm256_add_pd(half_sum, radius);
+            __m256d numerator = _mm256_mul_pd(four_pi_squared, _mm256_mul_pd(_mm256_mul_pd(r_value, r_value), r_value));
+            __m256d period_squared = _mm256_mul_pd(period, period);
+            __m256d velocity = _mm256_div_pd(_mm256_mul_pd(circumference, half_sum), period);
+
+            _mm256_storeu_pd(b.kepler_x + i, _mm256_div_pd(numerator, g));
+            _mm256_storeu_pd(b.kepler_y + i, period_squared);
+            _mm256_storeu_pd(b.kepler_mass + i, _mm256_div_pd(numerator, _mm256_mul_pd(period_squared, g)));
+            _mm256_storeu_pd(b.satellite_velocity + i, velocity);
+            _mm256_storeu_pd(b.secondary_mass + i, _mm256_div_pd(_mm256_mul_pd(_mm256_add_pd(radius, half_sum), _mm256_mul_pd(velocity, velocity)), g));
+        }
+
+        compute_scalar(b, i);
+    }
+
+    __attribute__((target("avx512f")))
+    void compute_avx512(const kepler_batch_t& b)
+    {
+        const __m512d half = _mm512_set1_pd(0.5);
+        const __m512d radius = _mm512_set1_pd(RADIUS_OF_THE_EARTH);
+        const __m512d four_pi_squared = _mm512_set1_pd(FOUR_PI_SQUARED);
+        const __m512d circumference = _mm512_set1_pd(TWO_PI_CIRCUMFERENCE);
+        const __m512d g = _mm512_set1_pd(GRAVITATIONAL_CONSTANT);
+
+        size_t i = 0;
+
+        for (; i + 8 <= b.count; i += 8)
+        {
+            __m512d period = _mm512_loadu_pd(b.period + i);
+            __m512d half_sum = _mm512_mul_pd(_mm512_add_pd(_mm512_loadu_pd(b.apogee + i), _mm512_loadu_pd(b.perigee + i)), half);
+            __m512d r_value = _mm512_add_pd(half_sum, radius);
+            __m512d numerator = _mm512_mul_pd(four_pi_squared, _mm512_mul_pd(_mm512_mul_pd(r_value, r_value), r_value));
+            __m512d period_squared = _mm512_mul_pd(period, period);
+            __m512d velocity = _mm512_div_pd(_mm512_mul_pd(circumference, half_sum), period);
+
+            _mm512_storeu_pd(b.kepler_x + i, _mm512_div_pd(numerator, g));
+            _mm512_storeu_pd(b.kepler_y + i, period_squared);
+            _mm512_storeu_pd(b.kepler_mass + i, _mm512_div_pd(numerator, _mm512_mul_pd(period_squared, g)));
+            _mm512_storeu_pd(b.satellite_velocity + i, velocity);
+            _mm512_storeu_pd(b.secondary_mass + i, _mm512_div_pd(_mm512_mul_pd(_mm512_add_pd(radius, half_sum), _mm512_mul_pd(velocity, velocity)), g));
+        }
+
+        compute_scalar(b, i);
+    }
+#endif
+}
+
+/**
+ * Runs the batch on the active instruction set (see set_active_isa()).
+ */
+void Kepler_fn::compute(const kepler_batch_t& batch)
+{
+    compute(batch, g_active_isa);
+}
+
+/**
+ * Runs the batch on a specific instruction set. The caller must make sure the CPU supports it.
+ */
+void Kepler_fn::compute(const kepler_batch_t& batch, kernel_isa_t isa)
+{
+    switch (isa)
+    {
+#ifdef KEPLER_KERNELS_X86
+        case kernel_isa_t::avx512: compute_avx512(batch); return;
+        case kernel_isa_t::avx2: compute_avx2(batch); return;
+        case kernel_isa_t::sse2: compute_sse2(batch); return;
+#endif
+        default: compute_scalar(batch, 0); return;
+    }
+}
+
+/**
+ * Returns the widest instruction set supported by the running CPU.
+ */
+kernel_isa_t Kepler_fn::detect_isa()
+{
+#ifdef KEPLER_KERNELS_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return kernel_isa_t::avx512;
+
+    if (__builtin_cpu_supports("avx2"))
+        return kernel_isa_t::avx2;
+
+    if (__builtin_cpu_supports("sse2"))
+        return kernel_isa_t::sse2;
+#endif
+
+    return kernel_isa_t::scalar;
+}
+
+kernel_isa_t Kepler_fn::active_isa()
+{
+    return g_active_isa;
+}
+
+/**
+ * Overrides the instruction set picked at start-up. Requests wider than what the CPU supports
+ * are refused.
+ *
+ * @return Whether the instruction set was accepted
+ */
+bool Kepler_fn::set_active_isa(kernel_isa_t isa)
+{
+    if (static_cast<int>(isa) > static_cast<int>(detect_isa()))
+        return false;
+
+    g_active_isa = isa;
+    return true;
+}
+
+const char* Kepler_fn::isa_name(kernel_isa_t isa)
+{
+    switch (isa)
+    {
+        case kernel_isa_t::avx512: return "avx512";
+        case kernel_isa_t::avx2: return "avx2";
+        case kernel_isa_t::sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+bool Kepler_fn::parse_isa(const std::string& name, kernel_isa_t& isa)
+{
+    for (kernel_isa_t candidate : {kernel_isa_t::scalar, kernel_isa_t::sse2, kernel_isa_t::avx2, kernel_isa_t::avx512})
+    {
+        if (name == isa_name(candidate))
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
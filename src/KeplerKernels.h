@@ -0,0 +1,56 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_KEPLERKERNELS_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_KEPLERKERNELS_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Instruction sets the batch kernels can run on.
+ */
+enum class kernel_isa_t {
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+/**
+ * Column pointers for one batch. All arrays hold count elements; the inputs are in SI units,
+ * as stored by UCSSatelliteColumns.
+ */
+struct kepler_batch_t {
+    const double* perigee;
+    const double* apogee;
+    const double* period;
+    double* kepler_x;
+    double* kepler_y;
+    double* kepler_mass;
+    double* satellite_velocity;
+    double* secondary_mass;
+    size_t count;
+};
+
+/**
+ * Batch versions of the Kepler and secondary-method computations. One call fills kepler_x,
+ * kepler_y, kepler_mass, satellite_velocity and secondary_mass for a whole column range using
+ * the widest instruction set the CPU supports.
+ *
+ * Every instruction set evaluates the same sequence of IEEE operations, so all of them return
+ * identical bits. Compared with the original pow() formulation, pow(x, 2) and pow(r, 3.0) are
+ * replaced by plain multiplications: kepler_y, satellite_velocity and secondary_mass come out
+ * bit-identical, kepler_x agrees to within 2 ULP and kepler_mass to within 4 ULP.
+ */
+namespace Kepler_fn
+{
+    void compute(const kepler_batch_t& batch);
+    void compute(const kepler_batch_t& batch, kernel_isa_t isa);
+
+    kernel_isa_t detect_isa();
+    kernel_isa_t active_isa();
+    bool set_active_isa(kernel_isa_t isa);
+
+    const char* isa_name(kernel_isa_t isa);
+    bool parse_isa(const std::string& name, kernel_isa_t& isa);
+}
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_KEPLERKERNELS_H
@@ -0,0 +1,247 @@
+#include "MEQSweepEngine.h"
+#include "Settings.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace
+{
+    const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * Sorts the satellites that can ever qualify (no missing or malformed parameters) by
+ * eccentricity and copies their mass estimations into that order, so a sweep reads them
+ * sequentially.
+ *
+ * @param columns     Column store whose result columns have already been computed
+ * @param snapshot_id Only index the rows of this snapshot (ALL_SNAPSHOTS for every row)
+ */
+MEQSweepIndex::MEQSweepIndex(const UCSSatelliteColumns& columns, int snapshot_id)
+    : satellite_count(0)
+{
+    std::vector<size_t> order;
+    order.reserve(columns.size());
+
+    for (size_t row = 0; row < columns.size(); ++row)
+    {
+        if (snapshot_id != ALL_SNAPSHOTS && columns.snapshot_id[row] != snapshot_id)
+            continue;
+
+        ++satellite_count;
+
+        if (columns.eligible.test(row))
+            order.push_back(row);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&columns](size_t a, size_t b) {
+        return columns.eccentricity[a] < columns.eccentricity[b];
+    });
+
+    eccentricity.reserve(order.size());
+    kepler_mass.reserve(order.size());
+    secondary_mass.reserve(order.size());
+    kepler_x.reserve(order.size());
+    kepler_y.reserve(order.size());
+
+    for (size_t row : order)
+    {
+        eccentricity.push_back(columns.eccentricity[row]);
+        kepler_mass.push_back(columns.kepler_mass[row]);
+        secondary_mass.push_back(columns.secondary_mass[row]);
+        kepler_x.push_back(columns.kepler_x[row]);
+        kepler_y.push_back(columns.kepler_y[row]);
+    }
+}
+
+/**
+ * Finds the [begin, end) range of the eccentricity order that qualifies under qualifier. This is
+ * a prefix (begin == 0) except for a qualifier of exactly zero, which only lets perfectly circular
+ * orbits through (see UCSSatelliteColumns::update_satellite_qualification) and therefore skips
+ * any negative eccentricities.
+ */
+void MEQSweepIndex::qualified_range(double qualifier, size_t &begin, size_t &end) const
+{
+    begin = 0;
+    end = std::upper_bound(eccentricity.begin(), eccentricity.end(), qualifier) - eccentricity.begin();
+
+    if (qualifier == 0)
+        begin = std::lower_bound(eccentricity.begin(), eccentricity.end(), 0.0) - eccentricity.begin();
+}
+
+/**
+ * Lists the qualifiers at which the qualified set changes within [min_qualifier, max_qualifier]:
+ * min_qualifier itself, followed by every distinct eccentricity above it up to max_qualifier.
+ * Evaluating exactly these yields one result per distinct qualified set and nothing else.
+ */
+std::vector<double> MEQSweepIndex::breakpoints(double min_qualifier, double max_qualifier) const
+{
+    std::vector<double> result {min_qualifier};
+
+    auto it = std::upper_bound(eccentricity.begin(), eccentricity.end(), min_qualifier);
+    auto end = std::upper_bound(eccentricity.begin(), eccentricity.end(), max_qualifier);
+
+    for (; it < end; it = std::upper_bound(it, end, *it))
+        result.push_back(*it);
+
+    return result;
+}
+
+/**
+ * @param index Sweep data shared with other engines; must outlive this engine
+ */
+MEQSweepEngine::MEQSweepEngine(const MEQSweepIndex& index)
+    : m_index(index), m_kepler_median(0.5), m_secondary_median(0.5)
+{
+    m_kepler_median.reserve(index.eccentricity.size());
+    m_secondary_median.reserve(index.eccentricity.size());
+}
+
+/**
+ * Moves the cursor, folding the satellites it passes over into the running moments, regression
+ * and medians.
+ * Neither supports removal, so moving the cursor back rebuilds them.
+ */
+void MEQSweepEngine::move_cursor(size_t cursor)
+{
+    if (cursor < m_cursor)
+    {
+        m_kepler_median.clear();
+        m_secondary_median.clear();
+        m_kepler_moments.clear();
+        m_secondary_moments.clear();
+        m_regression.clear();
+        m_cursor = 0;
+    }
+
+    for (; m_cursor < cursor; ++m_cursor)
+    {
+        m_kepler_median.insert(m_index.kepler_mass[m_cursor]);
+        m_secondary_median.insert(m_index.secondary_mass[m_cursor]);
+        m_kepler_moments.add(m_index.kepler_mass[m_cursor]);
+        m_secondary_moments.add(m_index.secondary_mass[m_cursor]);
+        m_regression.add(m_index.kepler_x[m_cursor], m_index.kepler_y[m_cursor]);
+    }
+}
+
+/**
+ * Selects the medians of an arbitrary [begin, end) window, the same way Util_fn::vector_median does.
+ */
+void MEQSweepEngine::compute_medians(size_t begin, size_t end, double &kepler_median, double &secondary_median)
+{
+    if (begin == end)
+    {
+        kepler_median = secondary_median = NOT_A_NUMBER;
+        return;
+    }
+
+    size_t n = (end - begin) / 2;
+
+    m_median_scratch.assign(m_index.kepler_mass.begin() + begin, m_index.kepler_mass.begin() + end);
+    std::nth_element(m_median_scratch.begin(), m_median_scratch.begin() + n, m_median_scratch.end());
+    kepler_median = m_median_scratch[n];
+
+    m_median_scratch.assign(m_index.secondary_mass.begin() + begin, m_index.secondary_mass.begin() + end);
+    std::nth_element(m_median_scratch.begin(), m_median_scratch.begin() + n, m_median_scratch.end());
+    secondary_median = m_median_scratch[n];
+}
+
+/**
+ * Computes the statistics of an arbitrary [begin, end) window from scratch. Only needed when
+ * the qualified set is not a prefix of the eccentricity order (see evaluate()).
+ */
+ecm_analysis_t MEQSweepEngine::analyze_window(double qualifier, size_t begin, size_t end)
+{
+    Util_fn::running_moments_t kepler = Util_fn::moments_of(m_index.kepler_mass.data() + begin, end - begin);
+    Util_fn::running_moments_t secondary = Util_fn::moments_of(m_index.secondary_mass.data() + begin, end - begin);
+    Util_fn::running_regression_t regression = Util_fn::regression_of(m_index.kepler_x.data() + begin, m_index.kepler_y.data() + begin, end - begin);
+
+    double kep_median, sec_median;
+    compute_medians(begin, end, kep_median, sec_median);
+
+    return make_analysis(qualifier, kepler.mean(), kep_median, kepler.standard_deviation(), secondary.mean(), sec_median,
+                         secondary.standard_deviation(), m_index.satellite_count - static_cast<int>(end - begin), regression);
+}
+
+/**
+ * Evaluates one MEQ step. Consecutive calls are cheapest with non-decreasing qualifiers, but
+ * any order is allowed.
+ *
+ * @param qualifier Maximum eccentricity value allowed to be a qualifier satellite
+ * @return The statistics of the satellites that qualify under this qualifier
+ */
+ecm_analysis_t MEQSweepEngine::evaluate(double qualifier)
+{
+    size_t begin, end;
+    m_index.qualified_range(qualifier, begin, end);
+
+    if (begin != 0)
+        return analyze_window(qualifier, begin, end);
+
+    move_cursor(end);
+
+    return make_analysis(qualifier, m_kepler_moments.mean(), m_kepler_median.value(), m_kepler_moments.standard_deviation(),
+                         m_secondary_moments.mean(), m_secondary_median.value(), m_secondary_moments.standard_deviation(),
+                         m_index.satellite_count - static_cast<int>(m_cursor), m_regression);
+}
+
+/**
+ * Evaluates every qualifier across the pool. The qualifiers are cut into contiguous blocks;
+ * every worker keeps one engine and, since blocks are handed out in increasing order, mostly
+ * moves its cursor forward from one block to the next when the qualifiers are ascending.
+ *
+ * @return One ecm_analysis_t per qualifier, in the same order
+ */
+std::vector<ecm_analysis_t> MEQSweepEngine::sweep(const MEQSweepIndex& index, const std::vector<double>& qualifiers, ThreadPool& pool)
+{
+    std::vector<ecm_analysis_t> results(qualifiers.size());
+
+    if (qualifiers.empty())
+        return results;
+
+    size_t block_count = std::min(qualifiers.size(), static_cast<size_t>(pool.size()) * 4);
+    size_t block_size = (qualifiers.size() + block_count - 1) / block_count;
+
+    std::vector<std::unique_ptr<MEQSweepEngine>> engines(pool.size());
+
+    pool.parallel_for(block_count, [&](size_t block, unsigned worker) {
+        if (!engines[worker])
+            engines[worker] = std::make_unique<MEQSweepEngine>(index);
+
+        size_t end = std::min(qualifiers.size(), (block + 1) * block_size);
+
+        for (size_t i = block * block_size; i < end; ++i)
+            results[i] = engines[worker]->evaluate(qualifiers[i]);
+    });
+
+    return results;
+}
+
+/**
+ * Derives the percentage errors, relative precision and regression mass and packs everything
+ * into an ecm_analysis_t.
+ */
+ecm_analysis_t MEQSweepEngine::make_analysis(double qualifier, double kep_mean, double kep_median, double kep_precision,
+                                             double sec_mean, double sec_median, double sec_precision, int sats_disqualified,
+                                             const Util_fn::running_regression_t& regression)
+{
+    double kep_percent_error_mean         = std::fabs(((kep_mean - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
+    double kep_percent_error_median       = std::fabs(((kep_median - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
+    double kep_percent_standard_deviation = (kep_precision / kep_mean) * 100;
+
+    double sec_percent_error_mean         = std::fabs(((sec_mean - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
+    double sec_percent_error_median       = std::fabs(((sec_median - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
+
+    double regression_slope               = regression.slope();
+    double regression_mass                = 1 / regression_slope;
+    double regression_percent_error       = std::fabs(((regression_mass - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
+
+    return {
+            qualifier, kep_mean, kep_median, kep_precision, kep_percent_error_mean,
+            kep_percent_error_median, kep_percent_standard_deviation, sec_mean, sec_median, sec_precision,
+            sec_percent_error_mean, sec_percent_error_median, sats_disqualified,
+            regression_slope, regression.intercept(), regression.r_squared(), regression.slope_standard_error(),
+            regression_mass, regression_percent_error
+    };
+}
@@ -0,0 +1,72 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_MEQSWEEPENGINE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_MEQSWEEPENGINE_H
+
+#include <vector>
+#include "RunningMoments.h"
+#include "RunningQuantile.h"
+#include "ThreadPool.h"
+#include "UCSSatelliteColumns.h"
+#include "ecm_analysis_t.h"
+
+/**
+ * Immutable eccentricity-ordered copy of the data an MEQ sweep needs. It is built once and can
+ * be shared by any number of MEQSweepEngine instances, including ones on different threads.
+ */
+class MEQSweepIndex
+{
+public:
+    static constexpr int ALL_SNAPSHOTS = -1; /*!< Snapshot id that selects every row */
+
+    int satellite_count; /*!< Number of rows in the whole database (or snapshot), qualifying or not */
+    std::vector<double> eccentricity; /*!< Eccentricities of the usable satellites, ascending */
+    std::vector<mass_t> kepler_mass; /*!< Kepler mass estimations, in eccentricity order */
+    std::vector<mass_t> secondary_mass; /*!< Secondary mass estimations, in eccentricity order */
+    std::vector<double> kepler_x; /*!< Kepler regression coordinates, in eccentricity order */
+    std::vector<double> kepler_y; /*!< Kepler regression coordinates, in eccentricity order */
+
+    explicit MEQSweepIndex(const UCSSatelliteColumns& columns, int snapshot_id = ALL_SNAPSHOTS);
+
+    void qualified_range(double qualifier, size_t &begin, size_t &end) const;
+    std::vector<double> breakpoints(double min_qualifier, double max_qualifier) const;
+};
+
+/**
+ * Evaluates MEQ steps incrementally. Raising the eccentricity qualifier only ever adds
+ * satellites to the qualified set, so instead of a qualification mask the engine keeps a cursor
+ * into the MEQSweepIndex order: moving to a new qualifier adds (or, when going back, removes)
+ * only the satellites between the old and the new cursor to running moments, a running
+ * regression and a pair of running medians.
+ *
+ * All mutable state lives in the engine, so one engine per thread can sweep a shared index.
+ */
+class MEQSweepEngine
+{
+private:
+    const MEQSweepIndex& m_index; /*!< Shared, read-only sweep data */
+
+    size_t m_cursor = 0; /*!< The satellites in [0, m_cursor) are currently qualified */
+    Util_fn::running_moments_t m_kepler_moments; /*!< Mean / variance of the Kepler masses in [0, m_cursor) */
+    Util_fn::running_moments_t m_secondary_moments; /*!< Mean / variance of the secondary masses in [0, m_cursor) */
+    Util_fn::running_regression_t m_regression; /*!< Least-squares fit of the Kepler coordinates in [0, m_cursor) */
+
+    RunningQuantile m_kepler_median; /*!< Median of the Kepler masses in [0, m_cursor) */
+    RunningQuantile m_secondary_median; /*!< Median of the secondary masses in [0, m_cursor) */
+    std::vector<mass_t> m_median_scratch; /*!< Reused buffer for the median selection of arbitrary windows */
+
+    void move_cursor(size_t cursor);
+    void compute_medians(size_t begin, size_t end, double &kepler_median, double &secondary_median);
+    ecm_analysis_t analyze_window(double qualifier, size_t begin, size_t end);
+public:
+    explicit MEQSweepEngine(const MEQSweepIndex& index);
+
+    ecm_analysis_t evaluate(double qualifier);
+
+    static std::vector<ecm_analysis_t> sweep(const MEQSweepIndex& index, const std::vector<double>& qualifiers, ThreadPool& pool);
+
+    static ecm_analysis_t make_analysis(double qualifier, double kep_mean, double kep_median, double kep_precision,
+                                        double sec_mean, double sec_median, double sec_precision, int sats_disqualified,
+                                        const Util_fn::running_regression_t& regression);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_MEQSWEEPENGINE_H
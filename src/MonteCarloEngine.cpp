@@ -0,0 +1,143 @@
+#include "MonteCarloEngine.h"
+#include "KeplerKernels.h"
+#include "RunningMoments.h"
+#include "Settings.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+    const double TWO_PI = 2 * M_PI;
+
+    // Layout of every block buffer, in blocks of SELECTION_GATHER_ROWS values.
+    enum block_slot_t {
+        SLOT_PERIGEE, SLOT_APOGEE, SLOT_PERIOD,
+        SLOT_KEPLER_X, SLOT_KEPLER_Y, SLOT_KEPLER_MASS, SLOT_VELOCITY, SLOT_SECONDARY_MASS, SLOT_COUNT
+    };
+
+    /**
+     * Turns one random value into an error of unit scale: uniform on [-1, 1), or standard normal
+     * (Box-Muller on its two 32-bit halves).
+     */
+    inline double unit_error(uint64_t random, bool normal)
+    {
+        if (!normal)
+            return static_cast<double>(random >> 11) * 0x1.0p-52 - 1;
+
+        double u1 = (static_cast<double>(random >> 32) + 1) * 0x1.0p-32;
+        double u2 = static_cast<double>(random & 0xffffffffULL) * 0x1.0p-32;
+
+        return sqrt(-2 * log(u1)) * cos(TWO_PI * u2);
+    }
+}
+
+/**
+ * @param pool   Workers to spread the trials across; must outlive this engine
+ * @param trials Number of perturbed trials per run
+ * @param model  How the inputs are perturbed
+ * @param seed   Seed of the generator; equal seeds give equal results
+ */
+MonteCarloEngine::MonteCarloEngine(ThreadPool& pool, int trials, const uncertainty_model_t& model, uint64_t seed)
+    : m_pool(pool), m_trials(trials), m_model(model), m_seed(seed), m_blocks(pool.size()),
+      m_kepler_means(trials), m_sec_means(trials), m_regression_masses(trials)
+{
+}
+
+/**
+ * Runs trial trial_id over every satellite and stores its statistics in slot trial_id. With
+ * perturb false the inputs are used as they are.
+ */
+void MonteCarloEngine::trial(const double* perigee, const double* apogee, const double* period, size_t count,
+                             size_t trial_id, bool perturb, aligned_vector<double>& block)
+{
+    if (block.size() != SLOT_COUNT * SELECTION_GATHER_ROWS)
+        block.resize(SLOT_COUNT * SELECTION_GATHER_ROWS);
+
+    double* slot[SLOT_COUNT];
+
+    for (int i = 0; i < SLOT_COUNT; ++i)
+        slot[i] = block.data() + i * SELECTION_GATHER_ROWS;
+
+    uint64_t stream = Util_fn::counter_random(m_seed, trial_id);
+    double altitude_error = perturb ? m_model.altitude_error : 0;
+    double period_error = perturb ? m_model.period_error : 0;
+
+    Util_fn::running_moments_t kepler, secondary;
+    Util_fn::running_regression_t regression;
+
+    for (size_t first = 0; first < count; first += SELECTION_GATHER_ROWS)
+    {
+        size_t block_count = std::min(SELECTION_GATHER_ROWS, count - first);
+
+        for (size_t i = 0; i < block_count; ++i)
+        {
+            uint64_t counter = 3 * (first + i);
+
+            slot[SLOT_PERIGEE][i] = perigee[first + i] + altitude_error * unit_error(Util_fn::counter_random(stream, counter), m_model.normal);
+            slot[SLOT_APOGEE][i] = apogee[first + i] + altitude_error * unit_error(Util_fn::counter_random(stream, counter + 1), m_model.normal);
+            slot[SLOT_PERIOD][i] = period[first + i] + period_error * unit_error(Util_fn::counter_random(stream, counter + 2), m_model.normal);
+        }
+
+        kepler_batch_t batch = {
+                slot[SLOT_PERIGEE], slot[SLOT_APOGEE], slot[SLOT_PERIOD], slot[SLOT_KEPLER_X], slot[SLOT_KEPLER_Y],
+                slot[SLOT_KEPLER_MASS], slot[SLOT_VELOCITY], slot[SLOT_SECONDARY_MASS], block_count
+        };
+
+        Kepler_fn::compute(batch);
+
+        kepler.merge(Util_fn::moments_of(slot[SLOT_KEPLER_MASS], block_count));
+        secondary.merge(Util_fn::moments_of(slot[SLOT_SECONDARY_MASS], block_count));
+        regression.merge(Util_fn::regression_of(slot[SLOT_KEPLER_X], slot[SLOT_KEPLER_Y], block_count));
+    }
+
+    m_kepler_means[trial_id] = kepler.mean();
+    m_sec_means[trial_id] = secondary.mean();
+    m_regression_masses[trial_id] = 1 / regression.slope();
+}
+
+/**
+ * Summarizes the statistic of every trial. The nominal value is filled in by run().
+ */
+mc_distribution_t MonteCarloEngine::distribution(const std::vector<double>& statistics) const
+{
+    Util_fn::running_moments_t moments = Util_fn::moments_of(statistics.data(), static_cast<size_t>(m_trials));
+
+    return {NOT_A_NUMBER, moments.mean(), moments.standard_deviation(), moments.min, moments.max};
+}
+
+/**
+ * Propagates the input errors of the given satellites (SI units, as in UCSSatelliteColumns).
+ *
+ * @return The nominal value and the spread across trials of every statistic; NaN when there are
+ *         no satellites or no trials are configured
+ */
+ecm_uncertainty_t MonteCarloEngine::run(const double* perigee, const double* apogee, const double* period, size_t count)
+{
+    if (count == 0 || m_trials <= 0)
+    {
+        mc_distribution_t none {NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER};
+        return {none, none, none};
+    }
+
+    size_t trials = static_cast<size_t>(m_trials);
+    size_t block_count = std::min(trials, static_cast<size_t>(m_pool.size()) * 4);
+    size_t block_size = (trials + block_count - 1) / block_count;
+
+    m_pool.parallel_for(block_count, [&](size_t block, unsigned worker) {
+        size_t end = std::min(trials, (block + 1) * block_size);
+
+        for (size_t t = block * block_size; t < end; ++t)
+            trial(perigee, apogee, period, count, t, true, m_blocks[worker]);
+    });
+
+    ecm_uncertainty_t result = {distribution(m_kepler_means), distribution(m_sec_means), distribution(m_regression_masses)};
+
+    // The unperturbed pass reuses slot 0 once every trial has been summarized.
+    trial(perigee, apogee, period, count, 0, false, m_blocks[0]);
+    result.kepler_mean.nominal = m_kepler_means[0];
+    result.sec_mean.nominal = m_sec_means[0];
+    result.regression_mass.nominal = m_regression_masses[0];
+
+    return result;
+}
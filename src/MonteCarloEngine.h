@@ -0,0 +1,71 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_MONTECARLOENGINE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_MONTECARLOENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+#include "UCSSatelliteColumns.h"
+
+/**
+ * Error model of the orbital inputs. UCS rounds altitudes to the kilometre and periods to the
+ * hundredth of a minute, which the default uniform model reproduces.
+ */
+struct uncertainty_model_t {
+    bool normal = false; /*!< Gaussian errors with the given standard deviations instead of uniform rounding errors */
+    double altitude_error = 500; /*!< Half-width (uniform) or standard deviation (normal) of perigee / apogee errors (m) */
+    double period_error = 0.3; /*!< Half-width (uniform) or standard deviation (normal) of period errors (s) */
+};
+
+/**
+ * Spread of one statistic across the Monte Carlo trials.
+ */
+struct mc_distribution_t {
+    double nominal; /*!< Value from the unperturbed inputs */
+    double mean;
+    double std_dev;
+    double min;
+    double max;
+};
+
+/**
+ * Result of one Monte Carlo run.
+ */
+struct ecm_uncertainty_t {
+    mc_distribution_t kepler_mean; /*!< Mean Kepler mass estimation */
+    mc_distribution_t sec_mean; /*!< Mean secondary mass estimation */
+    mc_distribution_t regression_mass; /*!< Earth mass implied by the Kepler regression slope */
+};
+
+/**
+ * Monte Carlo propagation of input rounding errors. Every trial perturbs the perigee, apogee and
+ * period of every satellite according to the error model and reruns the Kepler / secondary-method
+ * batch kernel over the perturbed inputs, a block of SELECTION_GATHER_ROWS satellites at a time;
+ * the spread of the resulting statistics across trials is how much of the mass error the rounding
+ * alone can explain.
+ *
+ * Trials are spread across the pool, each worker reusing one aligned block buffer. The
+ * perturbation of input k of satellite i in trial t is a Util_fn::counter_random value indexed by
+ * (seed, t, 3 i + k), so the results do not depend on the thread count.
+ */
+class MonteCarloEngine
+{
+private:
+    ThreadPool& m_pool; /*!< Workers the trials are spread across */
+    int m_trials; /*!< Trials per run */
+    uncertainty_model_t m_model; /*!< How the inputs are perturbed */
+    uint64_t m_seed; /*!< Seed of the counter-based generator */
+
+    std::vector<aligned_vector<double>> m_blocks; /*!< Kernel inputs and outputs, one block buffer per pool worker */
+    std::vector<double> m_kepler_means, m_sec_means, m_regression_masses; /*!< Statistic of every trial */
+
+    void trial(const double* perigee, const double* apogee, const double* period, size_t count, size_t trial_id,
+               bool perturb, aligned_vector<double>& block);
+    mc_distribution_t distribution(const std::vector<double>& statistics) const;
+public:
+    MonteCarloEngine(ThreadPool& pool, int trials, const uncertainty_model_t& model, uint64_t seed);
+
+    ecm_uncertainty_t run(const double* perigee, const double* apogee, const double* period, size_t count);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_MONTECARLOENGINE_H
@@ -0,0 +1,121 @@
+#include "QualificationKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QUALIFICATION_KERNELS_X86 1
+#endif
+
+namespace
+{
+    const size_t WORD_BITS = 64;
+
+    /**
+     * Reference implementation; packs the verdicts of rows [begin, begin + count) into one word.
+     */
+    uint64_t qualify_scalar(const double* eccentricity, size_t begin, size_t count, double qualifier)
+    {
+        uint64_t word = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            double e = eccentricity[begin + i];
+            bool qualifies = (qualifier != 0) ? (e <= qualifier) : (e == 0);
+            word |= uint64_t(qualifies) << i;
+        }
+
+        return word;
+    }
+
+#ifdef QUALIFICATION_KERNELS_X86
+    __attribute__((target("sse2")))
+    uint64_t qualify_word_sse2(const double* eccentricity, double qualifier)
+    {
+        const __m128d q = _mm_set1_pd(qualifier);
+        uint64_t word = 0;
+
+        for (size_t i = 0; i < WORD_BITS; i += 2)
+        {
+            __m128d e = _mm_loadu_pd(eccentricity + i);
+            __m128d verdict = (qualifier != 0) ? _mm_cmple_pd(e, q) : _mm_cmpeq_pd(e, q);
+            word |= uint64_t(_mm_movemask_pd(verdict)) << i;
+        }
+
+        return word;
+    }
+
+    __attribute__((target("avx2")))
+    uint64_t qualify_word_avx2(const double* eccentricity, double qualifier)
+    {
+        const __m256d q = _mm256_set1_pd(qualifier);
+        uint64_t word = 0;
+
+        for (size_t i = 0; i < WORD_BITS; i += 4)
+        {
+            __m256d e = _mm256_loadu_pd(eccentricity + i);
+            __m256d verdict = (qualifier != 0) ? _mm256_cmp_pd(e, q, _CMP_LE_OQ) : _mm256_cmp_pd(e, q, _CMP_EQ_OQ);
+            word |= uint64_t(_mm256_movemask_pd(verdict)) << i;
+        }
+
+        return word;
+    }
+
+    __attribute__((target("avx512f")))
+    uint64_t qualify_word_avx512(const double* eccentricity, double qualifier)
+    {
+        const __m512d q = _mm512_set1_pd(qualifier);
+        uint64_t word = 0;
+
+        for (size_t i = 0; i < WORD_BITS; i += 8)
+        {
+            __m512d e = _mm512_loadu_pd(eccentricity + i);
+            __mmask8 verdict = (qualifier != 0) ? _mm512_cmp_pd_mask(e, q, _CMP_LE_OQ) : _mm512_cmp_pd_mask(e, q, _CMP_EQ_OQ);
+            word |= uint64_t(verdict) << i;
+        }
+
+        return word;
+    }
+#endif
+}
+
+/**
+ * Evaluates the rule on the active instruction set (see Kepler_fn::set_active_isa()).
+ */
+void Qualification_fn::qualify(const double* eccentricity, const uint64_t* eligible, uint64_t* qualifying, size_t count, double qualifier)
+{
+    qualify(eccentricity, eligible, qualifying, count, qualifier, Kepler_fn::active_isa());
+}
+
+/**
+ * Fills the (count + 63) / 64 words of qualifying. Bits past count come out clear.
+ *
+ * @param eccentricity Eccentricity column, count rows
+ * @param eligible     Eligibility bits, one word per 64 rows
+ * @param qualifying   Receives the qualification bits
+ * @param isa          Instruction set to use; the caller must make sure the CPU supports it
+ */
+void Qualification_fn::qualify(const double* eccentricity, const uint64_t* eligible, uint64_t* qualifying, size_t count, double qualifier,
+                               kernel_isa_t isa)
+{
+    size_t full_words = count / WORD_BITS;
+
+    for (size_t word = 0; word < full_words; ++word)
+    {
+        const double* block = eccentricity + word * WORD_BITS;
+        uint64_t verdict;
+
+        switch (isa)
+        {
+#ifdef QUALIFICATION_KERNELS_X86
+            case kernel_isa_t::avx512: verdict = qualify_word_avx512(block, qualifier); break;
+            case kernel_isa_t::avx2: verdict = qualify_word_avx2(block, qualifier); break;
+            case kernel_isa_t::sse2: verdict = qualify_word_sse2(block, qualifier); break;
+#endif
+            default: verdict = qualify_scalar(block, 0, WORD_BITS, qualifier); break;
+        }
+
+        qualifying[word] = verdict & eligible[word];
+    }
+
+    if (count % WORD_BITS != 0)
+        qualifying[full_words] = qualify_scalar(eccentricity, full_words * WORD_BITS, count % WORD_BITS, qualifier) & eligible[full_words];
+}
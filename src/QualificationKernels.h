@@ -0,0 +1,22 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_QUALIFICATIONKERNELS_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_QUALIFICATIONKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "KeplerKernels.h"
+
+/**
+ * Vectorized evaluation of the eccentricity qualification rule. The eccentricity column is
+ * compared against the qualifier several rows per instruction and the results are packed
+ * straight into 64-bit words, laid out like UCSBitmask.
+ *
+ * A row qualifies if it is eligible (every parameter present and well-formed) and its
+ * eccentricity is at most the qualifier, or exactly zero when the qualifier is zero.
+ */
+namespace Qualification_fn
+{
+    void qualify(const double* eccentricity, const uint64_t* eligible, uint64_t* qualifying, size_t count, double qualifier);
+    void qualify(const double* eccentricity, const uint64_t* eligible, uint64_t* qualifying, size_t count, double qualifier, kernel_isa_t isa);
+}
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_QUALIFICATIONKERNELS_H
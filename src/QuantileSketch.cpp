@@ -0,0 +1,182 @@
+#include "QuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+/**
+ * @param k Capacity of the top level; larger values tighten the error bound
+ */
+QuantileSketch::QuantileSketch(size_t k)
+    : m_k(std::max<size_t>(k, 2))
+{
+    grow();
+}
+
+/**
+ * Capacity of a level: k at the top, shrinking by 2/3 per level below it, but at least 2.
+ */
+size_t QuantileSketch::capacity(size_t level) const
+{
+    size_t depth = m_levels.size() - 1 - level;
+    return std::max<size_t>(2, static_cast<size_t>(std::ceil(static_cast<double>(m_k) * std::pow(2.0 / 3.0, static_cast<double>(depth)))));
+}
+
+/**
+ * Adds a level on top, which raises the capacity of every level below it.
+ */
+void QuantileSketch::grow()
+{
+    m_levels.emplace_back();
+    m_max_size = 0;
+
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        m_max_size += capacity(level);
+}
+
+/**
+ * Compacts the lowest full level into the one above it until the sketch fits its capacity again.
+ */
+void QuantileSketch::compress()
+{
+    for (size_t level = 0; level < m_levels.size() && m_size >= m_max_size; ++level)
+    {
+        if (m_levels[level].items.size() < capacity(level))
+            continue;
+
+        // Growing may move the levels, so they are only referenced afterwards.
+        if (level + 1 == m_levels.size())
+            grow();
+
+        std::vector<double>& items = m_levels[level].items;
+
+        // An odd value out stays behind; the rest are sorted and every other one moves up.
+        double leftover = 0;
+        bool has_leftover = items.size() % 2 != 0;
+
+        if (has_leftover)
+        {
+            leftover = items.back();
+            items.pop_back();
+        }
+
+        std::sort(items.begin(), items.end());
+
+        std::vector<double>& above = m_levels[level + 1].items;
+        size_t offset = m_levels[level].keep_odd ? 1 : 0;
+
+        for (size_t i = offset; i < items.size(); i += 2)
+            above.push_back(items[i]);
+
+        m_levels[level].keep_odd = !m_levels[level].keep_odd;
+        m_size -= items.size() / 2;
+        items.clear();
+
+        if (has_leftover)
+            items.push_back(leftover);
+    }
+}
+
+void QuantileSketch::add(double value)
+{
+    m_levels[0].items.push_back(value);
+    ++m_count;
+
+    if (++m_size >= m_max_size)
+        compress();
+}
+
+void QuantileSketch::add(const double* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        add(values[i]);
+}
+
+/**
+ * Folds other into this sketch, level by level; the result answers for every value added to
+ * either of them.
+ */
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    while (m_levels.size() < other.m_levels.size())
+        grow();
+
+    for (size_t level = 0; level < other.m_levels.size(); ++level)
+    {
+        const std::vector<double>& items = other.m_levels[level].items;
+        m_levels[level].items.insert(m_levels[level].items.end(), items.begin(), items.end());
+    }
+
+    m_count += other.m_count;
+    m_size += other.m_size;
+
+    while (m_size >= m_max_size)
+        compress();
+}
+
+void QuantileSketch::clear()
+{
+    m_levels.clear();
+    m_count = m_size = 0;
+    grow();
+}
+
+/**
+ * Returns the value at rank q * count() (0 <= q <= 1), picked the same way Util_fn::vector_median
+ * picks the median while the sketch is exact. NaN when the sketch is empty.
+ */
+double QuantileSketch::quantile(double q) const
+{
+    double value;
+    quantiles(&q, 1, &value);
+
+    return value;
+}
+
+/**
+ * Answers several quantile queries at once, sorting the retained values only once.
+ *
+ * @param q     The quantiles to look up, each in [0, 1]
+ * @param count Number of quantiles
+ * @param out   Receives the count values
+ */
+void QuantileSketch::quantiles(const double* q, size_t count, double* out) const
+{
+    if (m_count == 0)
+    {
+        std::fill(out, out + count, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    std::vector<std::pair<double, uint64_t>> weighted;
+    weighted.reserve(m_size);
+
+    for (size_t level = 0; level < m_levels.size(); ++level)
+    {
+        for (double item : m_levels[level].items)
+            weighted.emplace_back(item, uint64_t(1) << level);
+    }
+
+    std::sort(weighted.begin(), weighted.end());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // The first value whose cumulative weight passes the target rank.
+        double target = q[i] * static_cast<double>(m_count);
+        uint64_t cumulative = 0;
+
+        out[i] = weighted.back().first;
+
+        for (const auto& [item, weight] : weighted)
+        {
+            cumulative += weight;
+
+            if (static_cast<double>(cumulative) > target)
+            {
+                out[i] = item;
+                break;
+            }
+        }
+    }
+}
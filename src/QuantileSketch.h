@@ -0,0 +1,55 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_QUANTILESKETCH_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_QUANTILESKETCH_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Mergeable KLL quantile sketch. Values are kept in a stack of compactors; level h holds values
+ * that each stand for 2^h of the values added. When the sketch is full, the lowest full level is
+ * sorted and every other value of it moves up a level, which halves its size while keeping
+ * every rank within a bounded error. Level capacities shrink geometrically (by 2/3) downwards
+ * from k, so the sketch holds O(k) values however many are added.
+ *
+ * k sets the error bound: a quantile query is off by roughly 2 / k of the count in rank (about
+ * 1% for the default QUANTILE_SKETCH_K = 200); below k values the answers are exact.
+ * Sketches fed separately -- per block, per thread or per snapshot -- can be merged into one
+ * with the same guarantee. Compactions alternate which half they keep, so a sketch only depends
+ * on the values and the order they were added and merged in.
+ */
+class QuantileSketch
+{
+private:
+    /**
+     * One level of the sketch.
+     */
+    struct compactor_t {
+        std::vector<double> items;
+        bool keep_odd = false; /*!< Which half the next compaction keeps */
+    };
+
+    size_t m_k; /*!< Capacity of the top level */
+    size_t m_count = 0; /*!< Values added (including through merges) */
+    size_t m_size = 0; /*!< Values retained across all levels */
+    size_t m_max_size = 0; /*!< Sum of the level capacities */
+    std::vector<compactor_t> m_levels;
+
+    size_t capacity(size_t level) const;
+    void grow();
+    void compress();
+public:
+    explicit QuantileSketch(size_t k);
+
+    void add(double value);
+    void add(const double* values, size_t count);
+    void merge(const QuantileSketch& other);
+    void clear();
+
+    inline size_t count() const { return m_count; };
+
+    double quantile(double q) const;
+    void quantiles(const double* q, size_t count, double* out) const;
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_QUANTILESKETCH_H
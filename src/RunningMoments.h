@@ -0,0 +1,229 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGMOMENTS_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGMOMENTS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "Settings.h"
+
+namespace Util_fn
+{
+/**
+ * One-pass accumulator of count, mean, variance, min and max (Welford's algorithm). Each value
+ * only updates the mean and the sum of squared deviations from it, so the variance never comes
+ * from subtracting two large, nearly equal sums and stays accurate over very long inputs.
+ *
+ * Accumulators fed separately -- per SIMD lane, per block or per thread -- are combined with
+ * merge(), which gives the same statistics as feeding every value into one of them.
+ */
+    struct running_moments_t {
+        size_t count = 0; /*!< Values added */
+        double running_mean = 0; /*!< Mean of the values so far (0 while empty) */
+        double m2 = 0; /*!< Sum of squared deviations from mean */
+        double min = std::numeric_limits<double>::infinity(); /*!< Smallest value */
+        double max = -std::numeric_limits<double>::infinity(); /*!< Largest value */
+
+        inline void add(double value)
+        {
+            double delta = value - running_mean;
+
+            ++count;
+            running_mean += delta / static_cast<double>(count);
+            m2 += delta * (value - running_mean);
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+
+        inline void merge(const running_moments_t& other)
+        {
+            if (other.count == 0)
+                return;
+
+            if (count == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            double total = static_cast<double>(count + other.count);
+            double delta = other.running_mean - running_mean;
+
+            running_mean += delta * (static_cast<double>(other.count) / total);
+            m2 += other.m2 + delta * delta * (static_cast<double>(count) * static_cast<double>(other.count) / total);
+            count += other.count;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+
+        inline void clear() { *this = running_moments_t(); }
+
+        /**
+         * Mean of the values; NaN when nothing has been added.
+         */
+        inline double mean() const
+        {
+            return count == 0 ? std::numeric_limits<double>::quiet_NaN() : running_mean;
+        }
+
+        /**
+         * Population variance (divides by count, like vector_standard_deviation always has).
+         * NaN when nothing has been added.
+         */
+        inline double variance() const
+        {
+            return count == 0 ? std::numeric_limits<double>::quiet_NaN() : m2 / static_cast<double>(count);
+        }
+
+        inline double standard_deviation() const { return sqrt(variance()); }
+    };
+
+/**
+ * Accumulates count values in MOMENT_LANES interleaved accumulators, one per lane, and merges
+ * them at the end. The lanes have no dependency on each other, so their updates overlap
+ * instead of waiting on one long chain of divisions.
+ */
+    inline running_moments_t moments_of(const double* values, size_t count)
+    {
+        running_moments_t lanes[MOMENT_LANES];
+        size_t whole = count - count % MOMENT_LANES;
+
+        for (size_t i = 0; i < whole; i += MOMENT_LANES)
+        {
+            for (size_t lane = 0; lane < MOMENT_LANES; ++lane)
+                lanes[lane].add(values[i + lane]);
+        }
+
+        for (size_t i = whole; i < count; ++i)
+            lanes[0].add(values[i]);
+
+        for (size_t lane = 1; lane < MOMENT_LANES; ++lane)
+            lanes[0].merge(lanes[lane]);
+
+        return lanes[0];
+    }
+
+/**
+ * One-pass, mergeable least-squares fit of y = intercept + slope * x. Like running_moments_t it
+ * keeps the means and the co-moments (sums of products of deviations from the means) rather than
+ * raw sums, so the fit stays accurate when x and y are huge, as the Kepler coordinates are.
+ */
+    struct running_regression_t {
+        size_t count = 0; /*!< Points added */
+        double mean_x = 0, mean_y = 0; /*!< Means of the coordinates */
+        double c_xx = 0, c_yy = 0, c_xy = 0; /*!< Co-moments of the coordinates */
+
+        inline void add(double x, double y)
+        {
+            double dx = x - mean_x;
+            double dy = y - mean_y;
+
+            ++count;
+            mean_x += dx / static_cast<double>(count);
+            mean_y += dy / static_cast<double>(count);
+            c_xx += dx * (x - mean_x);
+            c_yy += dy * (y - mean_y);
+            c_xy += dx * (y - mean_y);
+        }
+
+        inline void merge(const running_regression_t& other)
+        {
+            if (other.count == 0)
+                return;
+
+            if (count == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            double total = static_cast<double>(count + other.count);
+            double weight = static_cast<double>(count) * static_cast<double>(other.count) / total;
+            double dx = other.mean_x - mean_x;
+            double dy = other.mean_y - mean_y;
+
+            mean_x += dx * (static_cast<double>(other.count) / total);
+            mean_y += dy * (static_cast<double>(other.count) / total);
+            c_xx += other.c_xx + dx * dx * weight;
+            c_yy += other.c_yy + dy * dy * weight;
+            c_xy += other.c_xy + dx * dy * weight;
+            count += other.count;
+        }
+
+        inline void clear() { *this = running_regression_t(); }
+
+        /**
+         * Slope of the fitted line; NaN with fewer than two points.
+         */
+        inline double slope() const
+        {
+            return count < 2 ? std::numeric_limits<double>::quiet_NaN() : c_xy / c_xx;
+        }
+
+        inline double intercept() const { return mean_y - slope() * mean_x; }
+
+        /**
+         * Coefficient of determination of the fit.
+         */
+        inline double r_squared() const { return count < 2 ? std::numeric_limits<double>::quiet_NaN() : (c_xy * c_xy) / (c_xx * c_yy); }
+
+        /**
+         * Standard error of the slope; NaN with fewer than three points.
+         */
+        inline double slope_standard_error() const
+        {
+            if (count < 3)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            double residual = std::max(0.0, c_yy - slope() * c_xy);
+            return sqrt(residual / static_cast<double>(count - 2) / c_xx);
+        }
+    };
+
+/**
+ * Fits count (x, y) points in MOMENT_LANES interleaved accumulators and merges them, the same way
+ * moments_of does.
+ */
+    inline running_regression_t regression_of(const double* x, const double* y, size_t count)
+    {
+        running_regression_t lanes[MOMENT_LANES];
+        size_t whole = count - count % MOMENT_LANES;
+
+        for (size_t i = 0; i < whole; i += MOMENT_LANES)
+        {
+            for (size_t lane = 0; lane < MOMENT_LANES; ++lane)
+                lanes[lane].add(x[i + lane], y[i + lane]);
+        }
+
+        for (size_t i = whole; i < count; ++i)
+            lanes[0].add(x[i], y[i]);
+
+        for (size_t lane = 1; lane < MOMENT_LANES; ++lane)
+            lanes[0].merge(lanes[lane]);
+
+        return lanes[0];
+    }
+
+/**
+ * SplitMix64 output function: a strong 64-bit mix of one value.
+ */
+    inline uint64_t mix64(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+/**
+ * Counter-based random numbers: value number counter of stream key. Unlike a stateful generator,
+ * any value can be computed on its own, in any order and on any thread, and is always the same.
+ * Streams are derived the same way: counter_random(seed, id) is the key of stream id.
+ */
+    inline uint64_t counter_random(uint64_t key, uint64_t counter)
+    {
+        return mix64(key + 0x9e3779b97f4a7c15ULL * (counter + 1));
+    }
+}
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGMOMENTS_H
@@ -0,0 +1,79 @@
+#include "RunningQuantile.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/**
+ * @param fraction Quantile to track, e.g. 0.5 for the median
+ */
+RunningQuantile::RunningQuantile(double fraction) : m_fraction(fraction) {}
+
+/**
+ * Number of values that belong in the lower heap once count values have been inserted.
+ */
+size_t RunningQuantile::target_lower_size(size_t count) const
+{
+    if (count == 0)
+        return 0;
+
+    return std::min(static_cast<size_t>(m_fraction * static_cast<double>(count)), count - 1);
+}
+
+/**
+ * Preallocates both heaps so that inserting up to count values does not allocate.
+ */
+void RunningQuantile::reserve(size_t count)
+{
+    m_lower.reserve(count);
+    m_upper.reserve(count);
+}
+
+void RunningQuantile::clear()
+{
+    m_lower.clear();
+    m_upper.clear();
+}
+
+/**
+ * Adds a value and moves at most one element across the heaps to keep the split in place.
+ */
+void RunningQuantile::insert(double value)
+{
+    if (!m_upper.empty() && value >= m_upper.front())
+    {
+        m_upper.push_back(value);
+        std::push_heap(m_upper.begin(), m_upper.end(), std::greater<>());
+    } else {
+        m_lower.push_back(value);
+        std::push_heap(m_lower.begin(), m_lower.end());
+    }
+
+    size_t target = target_lower_size(size());
+
+    while (m_lower.size() > target)
+    {
+        std::pop_heap(m_lower.begin(), m_lower.end());
+        m_upper.push_back(m_lower.back());
+        m_lower.pop_back();
+        std::push_heap(m_upper.begin(), m_upper.end(), std::greater<>());
+    }
+
+    while (m_lower.size() < target)
+    {
+        std::pop_heap(m_upper.begin(), m_upper.end(), std::greater<>());
+        m_lower.push_back(m_upper.back());
+        m_upper.pop_back();
+        std::push_heap(m_lower.begin(), m_lower.end());
+    }
+}
+
+/**
+ * Returns the tracked order statistic, or NaN while no values have been inserted.
+ */
+double RunningQuantile::value() const
+{
+    if (m_upper.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return m_upper.front();
+}
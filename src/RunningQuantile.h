@@ -0,0 +1,35 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGQUANTILE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGQUANTILE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Tracks one order statistic of a growing set of values with two heaps. The lower (max-)heap
+ * holds the floor(p * n) smallest values and the upper (min-)heap the rest, so the answer is
+ * always the top of the upper heap and each insertion costs O(log n).
+ *
+ * RunningQuantile(0.5) returns the element Util_fn::vector_median would select, i.e. the
+ * value of rank n / 2 for an even number of values.
+ */
+class RunningQuantile
+{
+private:
+    double m_fraction; /*!< Quantile being tracked, in [0, 1] */
+    std::vector<double> m_lower; /*!< Max-heap of the values below the quantile */
+    std::vector<double> m_upper; /*!< Min-heap of the quantile and the values above it */
+
+    size_t target_lower_size(size_t count) const;
+public:
+    explicit RunningQuantile(double fraction = 0.5);
+
+    void reserve(size_t count);
+    void clear();
+    void insert(double value);
+
+    double value() const;
+    inline size_t size() const { return m_lower.size() + m_upper.size(); };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_RUNNINGQUANTILE_H
@@ -6,13 +6,25 @@
 #define CPP_SATELLITE_ANALYZER_PROJECT_SETTINGS_H
 
 #include <cmath>
+#include <cstddef>
 
 const int    PRINTOFF_ROUND_SF = 5;
 const int    TABLE_OUTPUT_PADDING = 13;
+const int    MAX_REPORTED_FIELD_ERRORS = 20;
+const int    CHUNKS_PER_PARSE_WORKER = 4;
+const size_t STREAM_BATCH_ROWS = 4096;
+const size_t SELECTION_GATHER_ROWS = 1024;
+const size_t MOMENT_LANES = 4;
+const double BOOTSTRAP_CONFIDENCE = 0.95;
+const size_t QUANTILE_SKETCH_K = 200;
+const size_t REPORTED_QUANTILE_COUNT = 7;
+const double REPORTED_QUANTILES[REPORTED_QUANTILE_COUNT] = {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+const size_t ANALYSIS_SHARD_ROWS = 65536;
 const double GRAVITATIONAL_CONSTANT = 6.67e-11;
 const double RADIUS_OF_THE_EARTH = 6371 * pow(10, 3);
 const int    DISQ_REASON_MISSING_PARAMETER = -1;
 const int    DISQ_REASON_ECCENTRICITY = -2;
+const int    DISQ_REASON_MALFORMED_PARAMETER = -3;
 const double LITERATURE_VALUE = 5.97e24;
 
 #endif //CPP_SATELLITE_ANALYZER_PROJECT_SETTINGS_H
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+/**
+ * @param thread_count Total number of workers including the calling thread; 0 uses one per hardware thread
+ */
+ThreadPool::ThreadPool(unsigned thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned worker = 1; worker < thread_count; ++worker)
+        m_threads.emplace_back(&ThreadPool::worker_loop, this, worker);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wake.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+/**
+ * Claims and runs tasks of the current batch until none are left.
+ */
+void ThreadPool::drain(unsigned worker)
+{
+    for (size_t task = m_next_task++; task < m_task_count; task = m_next_task++)
+    {
+        try {
+            (*m_task)(task, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::worker_loop(unsigned worker)
+{
+    unsigned seen_generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seen_generation; });
+
+            if (m_stopping)
+                return;
+
+            seen_generation = m_generation;
+        }
+
+        drain(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busy_workers;
+        }
+
+        m_done.notify_one();
+    }
+}
+
+/**
+ * Runs task(i, worker) for every i in [0, task_count) and returns once all of them are done.
+ * Tasks are handed out in increasing order. If a task throws, the remaining tasks still run and
+ * the first exception is rethrown here.
+ */
+void ThreadPool::parallel_for(size_t task_count, const task_fn_t& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_task_count = task_count;
+        m_next_task = 0;
+        m_error = nullptr;
+        m_busy_workers = static_cast<unsigned>(m_threads.size());
+        ++m_generation;
+    }
+
+    m_wake.notify_all();
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy_workers == 0; });
+    m_task = nullptr;
+
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
@@ -0,0 +1,49 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_THREADPOOL_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads that run indexed tasks. The calling thread takes part as
+ * worker 0, so a pool of size 1 starts no threads at all and runs everything inline.
+ */
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t task, unsigned worker)> task_fn_t;
+private:
+    std::vector<std::thread> m_threads; /*!< Background workers 1..size()-1 */
+    std::mutex m_mutex;
+    std::condition_variable m_wake; /*!< Signalled when a new batch starts or the pool shuts down */
+    std::condition_variable m_done; /*!< Signalled when a background worker finishes a batch */
+
+    const task_fn_t* m_task = nullptr; /*!< Function of the running batch */
+    size_t m_task_count = 0; /*!< Number of tasks in the running batch */
+    std::atomic<size_t> m_next_task {0}; /*!< Next task index to hand out */
+    unsigned m_generation = 0; /*!< Incremented for every batch */
+    unsigned m_busy_workers = 0; /*!< Background workers still running the current batch */
+    bool m_stopping = false;
+    std::exception_ptr m_error; /*!< First exception thrown by a task of the current batch */
+
+    void worker_loop(unsigned worker);
+    void drain(unsigned worker);
+public:
+    explicit ThreadPool(unsigned thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    inline unsigned size() const { return static_cast<unsigned>(m_threads.size()) + 1; };
+
+    void parallel_for(size_t task_count, const task_fn_t& task);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_THREADPOOL_H
@@ -0,0 +1,92 @@
+#include "UCSBitmask.h"
+
+void UCSBitmask::reserve(size_t bits)
+{
+    m_words.reserve((bits + WORD_BITS - 1) / WORD_BITS);
+}
+
+void UCSBitmask::clear()
+{
+    m_words.clear();
+    m_size = 0;
+}
+
+/**
+ * Resizes the mask to bits bits, all set to value.
+ */
+void UCSBitmask::assign(size_t bits, bool value)
+{
+    m_words.assign((bits + WORD_BITS - 1) / WORD_BITS, value ? ~uint64_t(0) : 0);
+    m_size = bits;
+
+    if (value && bits % WORD_BITS != 0)
+        m_words.back() &= (uint64_t(1) << (bits % WORD_BITS)) - 1;
+}
+
+void UCSBitmask::push_back(bool value)
+{
+    if (m_size % WORD_BITS == 0)
+        m_words.push_back(0);
+
+    m_words.back() |= uint64_t(value) << (m_size % WORD_BITS);
+    ++m_size;
+}
+
+void UCSBitmask::set(size_t bit, bool value)
+{
+    uint64_t mask = uint64_t(1) << (bit % WORD_BITS);
+
+    if (value)
+        m_words[bit / WORD_BITS] |= mask;
+    else
+        m_words[bit / WORD_BITS] &= ~mask;
+}
+
+/**
+ * Appends every bit of other, a word at a time.
+ */
+void UCSBitmask::append(const UCSBitmask& other)
+{
+    size_t shift = m_size % WORD_BITS;
+
+    if (shift == 0)
+    {
+        m_words.insert(m_words.end(), other.m_words.begin(), other.m_words.end());
+    } else {
+        for (uint64_t word : other.m_words)
+        {
+            m_words.back() |= word << shift;
+            m_words.push_back(word >> (WORD_BITS - shift));
+        }
+    }
+
+    m_size += other.m_size;
+    m_words.resize((m_size + WORD_BITS - 1) / WORD_BITS);
+}
+
+/**
+ * Builds a selection vector: replaces the contents of rows with the index of every set bit, in
+ * ascending order. Reusing the same vector avoids allocating once it has grown large enough.
+ */
+void UCSBitmask::select(std::vector<uint32_t>& rows) const
+{
+    rows.clear();
+    rows.reserve(count());
+
+    for_each_set([&rows](size_t row) {
+        rows.push_back(static_cast<uint32_t>(row));
+    });
+}
+
+/**
+ * Returns the number of set bits.
+ */
+size_t UCSBitmask::count() const
+{
+    size_t total = 0;
+
+    for (uint64_t word : m_words)
+        total += static_cast<size_t>(__builtin_popcountll(word));
+
+    return total;
+}
@@ -0,0 +1,53 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSBITMASK_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSBITMASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Packed vector of bits, one per row, stored 64 to a word (row i is bit i % 64 of word i / 64).
+ * Bits past size() are always zero, so whole words can be counted and scanned without masking
+ * the last one.
+ */
+class UCSBitmask
+{
+private:
+    std::vector<uint64_t> m_words; /*!< The bits */
+    size_t m_size = 0; /*!< Number of bits in use */
+public:
+    static const size_t WORD_BITS = 64;
+
+    inline size_t size() const { return m_size; };
+    inline size_t word_count() const { return m_words.size(); };
+    inline uint64_t* words() { return m_words.data(); };
+    inline const uint64_t* words() const { return m_words.data(); };
+
+    inline bool test(size_t bit) const { return (m_words[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1; };
+    inline bool back() const { return test(m_size - 1); };
+
+    void reserve(size_t bits);
+    void clear();
+    void assign(size_t bits, bool value);
+    void push_back(bool value);
+    void set(size_t bit, bool value);
+    void append(const UCSBitmask& other);
+    size_t count() const;
+    void select(std::vector<uint32_t>& rows) const;
+
+    /**
+     * Calls f(row) for every set bit, in ascending order, skipping 64 clear bits at a time.
+     */
+    template<typename Function>
+    void for_each_set(Function f) const
+    {
+        for (size_t word = 0; word < m_words.size(); ++word)
+        {
+            for (uint64_t bits = m_words[word]; bits != 0; bits &= bits - 1)
+                f(word * WORD_BITS + static_cast<size_t>(__builtin_ctzll(bits)));
+        }
+    }
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSBITMASK_H
@@ -0,0 +1,93 @@
+#include "UCSCategoryDictionary.h"
+#include <limits>
+#include <stdexcept>
+
+UCSCategoryDictionary::UCSCategoryDictionary()
+{
+    intern(std::string_view());
+}
+
+UCSCategoryDictionary::UCSCategoryDictionary(const UCSCategoryDictionary& other)
+{
+    // m_codes points into the other dictionary's strings, so it is rebuilt rather than copied.
+    for (const std::string& value : other.m_values)
+        intern(value);
+}
+
+UCSCategoryDictionary& UCSCategoryDictionary::operator=(const UCSCategoryDictionary& other)
+{
+    if (this != &other)
+    {
+        m_codes.clear();
+        m_values.clear();
+
+        for (const std::string& value : other.m_values)
+            intern(value);
+    }
+
+    return *this;
+}
+
+/**
+ * Returns the code of value, adding it to the dictionary if it is new.
+ *
+ * @throws std::runtime_error if the column has more distinct values than a category_code_t can hold
+ */
+category_code_t UCSCategoryDictionary::intern(std::string_view value)
+{
+    auto found = m_codes.find(value);
+
+    if (found != m_codes.end())
+        return found->second;
+
+    if (m_values.size() > std::numeric_limits<category_code_t>::max())
+        throw std::runtime_error("A categorical column has more than " + std::to_string(std::numeric_limits<category_code_t>::max() + 1) + " distinct values");
+
+    category_code_t code = static_cast<category_code_t>(m_values.size());
+    m_values.emplace_back(value);
+    m_codes.emplace(m_values.back(), code);
+
+    return code;
+}
+
+/**
+ * Looks value up without adding it.
+ *
+ * @return Whether value is in the dictionary; if not, no row of the column holds it
+ */
+bool UCSCategoryDictionary::find(std::string_view value, category_code_t &code) const
+{
+    auto found = m_codes.find(value);
+
+    if (found == m_codes.end())
+        return false;
+
+    code = found->second;
+    return true;
+}
+
+/**
+ * Adds every value of another dictionary, e.g. one filled while parsing a separate chunk.
+ *
+ * @return For each code of other, the code of the same value in this dictionary
+ */
+std::vector<category_code_t> UCSCategoryDictionary::merge(const UCSCategoryDictionary& other)
+{
+    std::vector<category_code_t> translation;
+    translation.reserve(other.m_values.size());
+
+    for (const std::string& value : other.m_values)
+        translation.push_back(intern(value));
+
+    return translation;
+}
+
+/**
+ * Forgets every value but the empty string.
+ */
+void UCSCategoryDictionary::clear()
+{
+    m_codes.clear();
+    m_values.clear();
+    intern(std::string_view());
+}
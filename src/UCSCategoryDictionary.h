@@ -0,0 +1,53 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSCATEGORYDICTIONARY_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSCATEGORYDICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+typedef uint16_t category_code_t;
+
+/**
+ * The categorical (text) columns of the UCS database, which are stored as dictionary codes.
+ */
+enum ucs_category_t {
+    UCS_CATEGORY_ORBIT_CLASS, /*!< Class of Orbit (LEO, MEO, GEO, Elliptical) */
+    UCS_CATEGORY_COUNTRY, /*!< Country of Operator/Owner */
+    UCS_CATEGORY_OPERATOR, /*!< Operator/Owner */
+    UCS_CATEGORY_USERS, /*!< Users */
+    UCS_CATEGORY_PURPOSE, /*!< Purpose */
+    UCS_CATEGORY_COUNT
+};
+
+/**
+ * Interns the values of one categorical column. Every distinct value gets a small integer code,
+ * handed out in order of first appearance, so a column can be stored as one code per row and
+ * filtered or grouped by comparing integers. Code 0 is always the empty string.
+ */
+class UCSCategoryDictionary
+{
+private:
+    std::deque<std::string> m_values; /*!< Distinct values, indexed by code; a deque so that m_codes' keys never move */
+    std::unordered_map<std::string_view, category_code_t> m_codes; /*!< Code of each value, keyed by views into m_values */
+public:
+    UCSCategoryDictionary();
+    UCSCategoryDictionary(const UCSCategoryDictionary& other);
+    UCSCategoryDictionary(UCSCategoryDictionary&& other) noexcept = default;
+    UCSCategoryDictionary& operator=(const UCSCategoryDictionary& other);
+    UCSCategoryDictionary& operator=(UCSCategoryDictionary&& other) noexcept = default;
+
+    category_code_t intern(std::string_view value);
+    bool find(std::string_view value, category_code_t &code) const;
+    std::vector<category_code_t> merge(const UCSCategoryDictionary& other);
+    void clear();
+
+    inline const std::string& value(category_code_t code) const { return m_values[code]; };
+    inline size_t size() const { return m_values.size(); };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSCATEGORYDICTIONARY_H
@@ -0,0 +1,322 @@
+#include "UCSColumnCache.h"
+#include "UCSMappedFile.h"
+#include "Settings.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <sys/stat.h>
+
+using string = std::string;
+
+namespace
+{
+    const char CACHE_MAGIC[8] = {'U', 'C', 'S', 'C', 'A', 'C', 'H', 'E'};
+    const uint32_t CACHE_VERSION = 2;
+    const uint32_t CACHE_FLAG_SANITIZED = 1;
+    const uint64_t CACHE_ALIGNMENT = 64;
+
+    /* Column blocks, in file order. Each categorical column takes three blocks from
+     * CACHE_CATEGORY_BLOCKS on: its codes, then its dictionary as string offsets and text. */
+    enum cache_column_id : uint32_t {
+        CACHE_ROW_ID, CACHE_PARSE_REASON,
+        CACHE_LONGITUDE, CACHE_PERIGEE, CACHE_APOGEE, CACHE_ECCENTRICITY, CACHE_INCLINATION, CACHE_PERIOD,
+        CACHE_LAUNCH_MASS, CACHE_CATEGORY_BLOCKS,
+        CACHE_COLUMN_COUNT = CACHE_CATEGORY_BLOCKS + 3 * UCS_CATEGORY_COUNT
+    };
+
+    enum cache_category_block_t : uint32_t {
+        CACHE_CATEGORY_CODES, CACHE_CATEGORY_DICTIONARY_OFFSETS, CACHE_CATEGORY_DICTIONARY_TEXT
+    };
+
+    inline uint32_t category_block(int category, cache_category_block_t block)
+    {
+        return CACHE_CATEGORY_BLOCKS + 3 * category + block;
+    }
+
+    struct cache_header_t {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags; /*!< CACHE_FLAG_* bits describing the ingest options */
+        uint64_t source_size; /*!< Size of the source file in bytes */
+        int64_t source_mtime_ns; /*!< Modification time of the source file (informational; not used for validation) */
+        uint64_t source_hash; /*!< content_hash() of the source file */
+        uint64_t row_count;
+        uint32_t column_count;
+        uint32_t reserved;
+    };
+
+    struct cache_column_t {
+        uint32_t id;
+        uint32_t element_size; /*!< Bytes per row, or per element for the dictionary blocks */
+        uint64_t offset; /*!< From the start of the file; a multiple of CACHE_ALIGNMENT */
+        uint64_t length; /*!< In bytes */
+    };
+
+    bool stat_file(const string& path, uint64_t& size, int64_t& mtime_ns)
+    {
+        struct stat file_stat {};
+
+        if (stat(path.c_str(), &file_stat) != 0)
+            return false;
+
+        size = static_cast<uint64_t>(file_stat.st_size);
+        mtime_ns = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+        return true;
+    }
+
+    uint32_t flags_for(const ucs_ingest_options_t& options)
+    {
+        return options.sanitize ? CACHE_FLAG_SANITIZED : 0;
+    }
+
+    uint64_t align_up(uint64_t offset)
+    {
+        return (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+    }
+
+    /**
+     * Copies one fixed-width column block into a column vector.
+     */
+    template<typename Vector>
+    void read_block(std::string_view file, const cache_column_t& column, Vector& target)
+    {
+        target.resize(column.length / sizeof(typename Vector::value_type));
+        std::memcpy(target.data(), file.data() + column.offset, column.length);
+    }
+}
+
+/**
+ * Hashes a whole file's contents, eight bytes at a time, with the FNV-1a mixing step.
+ */
+uint64_t UCSColumnCache::content_hash(std::string_view data)
+{
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+
+    for (; i + 8 <= data.size(); i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+
+    for (; i < data.size(); ++i)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+
+    return hash;
+}
+
+/**
+ * Tries to fill columns from the snapshot at cache_path. The snapshot is used only if it was
+ * written by this version for the same ingest options and the source file still has the same
+ * content hash. A size mismatch rejects it early; the modification time is never trusted, since
+ * copies and archive extraction can keep it across an edit.
+ *
+ * @return Whether columns was filled; on false, columns is left untouched
+ */
+bool UCSColumnCache::load(const string& cache_path, const string& source_path, const ucs_ingest_options_t& options,
+                          double eccentricity_qualifier, UCSSatelliteColumns& columns)
+{
+    uint64_t cache_size, source_size;
+    int64_t cache_mtime, source_mtime;
+
+    if (!stat_file(cache_path, cache_size, cache_mtime) || !stat_file(source_path, source_size, source_mtime))
+        return false;
+
+    if (cache_size < sizeof(cache_header_t) + CACHE_COLUMN_COUNT * sizeof(cache_column_t))
+        return false;
+
+    UCSMappedFile mapped_cache(cache_path);
+    std::string_view file = mapped_cache.view();
+
+    cache_header_t header {};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION
+        || header.flags != flags_for(options) || header.column_count != CACHE_COLUMN_COUNT || header.source_size != source_size)
+        return false;
+
+    {
+        UCSMappedFile mapped_source(source_path);
+
+        if (content_hash(mapped_source.view()) != header.source_hash)
+            return false;
+    }
+
+    cache_column_t directory[CACHE_COLUMN_COUNT];
+    std::memcpy(directory, file.data() + sizeof(cache_header_t), sizeof(directory));
+
+    for (uint32_t id = 0; id < CACHE_COLUMN_COUNT; ++id)
+    {
+        const cache_column_t& column = directory[id];
+        bool is_dictionary = id >= CACHE_CATEGORY_BLOCKS && (id - CACHE_CATEGORY_BLOCKS) % 3 != CACHE_CATEGORY_CODES;
+
+        if (column.id != id || column.offset > file.size() || column.length > file.size() - column.offset
+            || (!is_dictionary && column.length != header.row_count * column.element_size))
+            return false;
+    }
+
+    size_t rows = header.row_count;
+    UCSSatelliteColumns loaded;
+
+    read_block(file, directory[CACHE_ROW_ID], loaded.satellite_row_id);
+    read_block(file, directory[CACHE_PARSE_REASON], loaded.parse_reason);
+    read_block(file, directory[CACHE_LONGITUDE], loaded.longitude);
+    read_block(file, directory[CACHE_PERIGEE], loaded.perigee);
+    read_block(file, directory[CACHE_APOGEE], loaded.apogee);
+    read_block(file, directory[CACHE_ECCENTRICITY], loaded.eccentricity);
+    read_block(file, directory[CACHE_INCLINATION], loaded.inclination);
+    read_block(file, directory[CACHE_PERIOD], loaded.period);
+    read_block(file, directory[CACHE_LAUNCH_MASS], loaded.launch_mass);
+
+    for (int category = 0; category < UCS_CATEGORY_COUNT; ++category)
+    {
+        std::vector<uint32_t> offsets;
+        read_block(file, directory[category_block(category, CACHE_CATEGORY_DICTIONARY_OFFSETS)], offsets);
+
+        const cache_column_t& text_block = directory[category_block(category, CACHE_CATEGORY_DICTIONARY_TEXT)];
+        std::string_view text = file.substr(text_block.offset, text_block.length);
+
+        if (offsets.empty() || offsets.size() - 1 > size_t(std::numeric_limits<category_code_t>::max()) + 1)
+            return false;
+
+        // Re-interning the values in order hands out the codes they were written with.
+        for (size_t code = 0; code + 1 < offsets.size(); ++code)
+        {
+            if (offsets[code] > offsets[code + 1] || offsets[code + 1] > text.size()
+                || loaded.categories[category].intern(text.substr(offsets[code], offsets[code + 1] - offsets[code])) != code)
+                return false;
+        }
+
+        std::vector<category_code_t>& codes = loaded.category_codes[category];
+        read_block(file, directory[category_block(category, CACHE_CATEGORY_CODES)], codes);
+
+        for (category_code_t code : codes)
+        {
+            if (code >= loaded.categories[category].size())
+                return false;
+        }
+    }
+
+    loaded.snapshot_id.assign(rows, 0);
+    loaded.eligible.reserve(rows);
+    loaded.qualifying.reserve(rows);
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        /* Same rule as at parse time: if the eccentricity is higher than the command-line
+         * parameter provided, disqualify this satellite. */
+        loaded.eligible.push_back(loaded.parse_reason[row] == 0);
+        loaded.qualifying.push_back(loaded.parse_reason[row] == 0 && !(loaded.eccentricity[row] > eccentricity_qualifier));
+    }
+
+    loaded.kepler_x.resize(rows);
+    loaded.kepler_y.resize(rows);
+    loaded.kepler_mass.resize(rows);
+    loaded.secondary_mass.resize(rows);
+    loaded.satellite_velocity.resize(rows);
+
+    columns = std::move(loaded);
+    return true;
+}
+
+/**
+ * Writes a snapshot of columns, parsed from source_path with options, to cache_path. The file
+ * is written under a temporary name and renamed into place, so readers never see half of it.
+ *
+ * @return Whether the snapshot was written
+ */
+bool UCSColumnCache::write(const string& cache_path, const string& source_path, const ucs_ingest_options_t& options,
+                           const UCSSatelliteColumns& columns)
+{
+    cache_header_t header {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.flags = flags_for(options);
+    header.row_count = columns.size();
+    header.column_count = CACHE_COLUMN_COUNT;
+
+    if (!stat_file(source_path, header.source_size, header.source_mtime_ns))
+        return false;
+
+    {
+        UCSMappedFile mapped_source(source_path);
+        header.source_hash = content_hash(mapped_source.view());
+    }
+
+    struct block_t { const void* data; uint32_t element_size; uint64_t length; };
+
+    block_t blocks[CACHE_COLUMN_COUNT] = {
+            {columns.satellite_row_id.data(), sizeof(int), columns.size() * sizeof(int)},
+            // Parse-time reasons only; the eccentricity verdict depends on the qualifier of the loading run.
+            {columns.parse_reason.data(), sizeof(int), columns.size() * sizeof(int)},
+            {columns.longitude.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.perigee.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.apogee.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.eccentricity.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.inclination.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.period.data(), sizeof(double), columns.size() * sizeof(double)},
+            {columns.launch_mass.data(), sizeof(double), columns.size() * sizeof(double)},
+    };
+
+    std::vector<uint32_t> dictionary_offsets[UCS_CATEGORY_COUNT];
+    string dictionary_text[UCS_CATEGORY_COUNT];
+
+    for (int category = 0; category < UCS_CATEGORY_COUNT; ++category)
+    {
+        const UCSCategoryDictionary& dictionary = columns.categories[category];
+        dictionary_offsets[category].push_back(0);
+
+        for (size_t code = 0; code < dictionary.size(); ++code)
+        {
+            dictionary_text[category] += dictionary.value(static_cast<category_code_t>(code));
+            dictionary_offsets[category].push_back(static_cast<uint32_t>(dictionary_text[category].size()));
+        }
+
+        const std::vector<category_code_t>& codes = columns.category_codes[category];
+
+        blocks[category_block(category, CACHE_CATEGORY_CODES)] = {codes.data(), sizeof(category_code_t), codes.size() * sizeof(category_code_t)};
+        blocks[category_block(category, CACHE_CATEGORY_DICTIONARY_OFFSETS)] =
+                {dictionary_offsets[category].data(), sizeof(uint32_t), dictionary_offsets[category].size() * sizeof(uint32_t)};
+        blocks[category_block(category, CACHE_CATEGORY_DICTIONARY_TEXT)] = {dictionary_text[category].data(), 1, dictionary_text[category].size()};
+    }
+
+    cache_column_t directory[CACHE_COLUMN_COUNT];
+    uint64_t offset = align_up(sizeof(cache_header_t) + sizeof(directory));
+
+    for (uint32_t id = 0; id < CACHE_COLUMN_COUNT; ++id)
+    {
+        directory[id] = {id, blocks[id].element_size, offset, blocks[id].length};
+        offset = align_up(offset + blocks[id].length);
+    }
+
+    string temporary_path = cache_path + ".tmp";
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    const char padding[CACHE_ALIGNMENT] = {};
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(directory), sizeof(directory));
+
+    uint64_t written = sizeof(header) + sizeof(directory);
+
+    for (uint32_t id = 0; id < CACHE_COLUMN_COUNT; ++id)
+    {
+        out.write(padding, static_cast<std::streamsize>(directory[id].offset - written));
+        out.write(static_cast<const char*>(blocks[id].data), static_cast<std::streamsize>(blocks[id].length));
+        written = directory[id].offset + blocks[id].length;
+    }
+
+    out.close();
+
+    if (!out || std::rename(temporary_path.c_str(), cache_path.c_str()) != 0)
+    {
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+
+    return true;
+}
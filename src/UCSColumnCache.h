@@ -0,0 +1,30 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNCACHE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "UCSSatelliteColumns.h"
+#include "ucs_ingest_options_t.h"
+
+/**
+ * Versioned binary snapshot of a parsed UCSSatelliteColumns store. The file starts with a header
+ * that identifies the source file (size and content hash) and the ingest
+ * options that shape the parsed data, followed by a directory and one 64-byte aligned block per
+ * column. Loading a valid snapshot maps it and copies the blocks straight into the column store,
+ * skipping tokenization and number parsing entirely.
+ *
+ * Only the parsed inputs are stored: the result columns are recomputed by the batch kernel and
+ * qualification is re-derived from the eccentricity qualifier of the current run.
+ */
+namespace UCSColumnCache
+{
+    bool load(const std::string& cache_path, const std::string& source_path, const ucs_ingest_options_t& options,
+              double eccentricity_qualifier, UCSSatelliteColumns& columns);
+    bool write(const std::string& cache_path, const std::string& source_path, const ucs_ingest_options_t& options,
+               const UCSSatelliteColumns& columns);
+
+    uint64_t content_hash(std::string_view data);
+}
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNCACHE_H
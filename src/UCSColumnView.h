@@ -0,0 +1,70 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNVIEW_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/**
+ * Non-owning view of one result column through a selection vector: element i is
+ * column[rows[i]]. Nothing is copied, so creating or reading a view never allocates; it stays
+ * valid until the column store or the selection changes.
+ */
+class UCSColumnView
+{
+private:
+    const double* m_column; /*!< Whole result column */
+    const uint32_t* m_rows; /*!< Selected rows, ascending */
+    size_t m_size; /*!< Number of selected rows */
+public:
+    /**
+     * Random-access iterator over the selected values.
+     */
+    class iterator
+    {
+    private:
+        const double* m_column;
+        const uint32_t* m_row;
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef double value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const double* pointer;
+        typedef const double& reference;
+
+        iterator(const double* column, const uint32_t* row) : m_column(column), m_row(row) {};
+
+        inline reference operator*() const { return m_column[*m_row]; };
+        inline reference operator[](difference_type n) const { return m_column[m_row[n]]; };
+        inline iterator& operator++() { ++m_row; return *this; };
+        inline iterator operator++(int) { iterator old = *this; ++m_row; return old; };
+        inline iterator& operator--() { --m_row; return *this; };
+        inline iterator operator--(int) { iterator old = *this; --m_row; return old; };
+        inline iterator& operator+=(difference_type n) { m_row += n; return *this; };
+        inline iterator& operator-=(difference_type n) { m_row -= n; return *this; };
+        inline iterator operator+(difference_type n) const { return {m_column, m_row + n}; };
+        inline iterator operator-(difference_type n) const { return {m_column, m_row - n}; };
+        inline difference_type operator-(const iterator& other) const { return m_row - other.m_row; };
+        inline bool operator==(const iterator& other) const { return m_row == other.m_row; };
+        inline bool operator!=(const iterator& other) const { return m_row != other.m_row; };
+        inline bool operator<(const iterator& other) const { return m_row < other.m_row; };
+    };
+
+    UCSColumnView(const double* column, const std::vector<uint32_t>& rows) : m_column(column), m_rows(rows.data()), m_size(rows.size()) {};
+
+    inline double operator[](size_t i) const { return m_column[m_rows[i]]; };
+    inline size_t size() const { return m_size; };
+    inline bool empty() const { return m_size == 0; };
+    inline iterator begin() const { return {m_column, m_rows}; };
+    inline iterator end() const { return {m_column, m_rows + m_size}; };
+
+    /**
+     * Copies the selected values into buffer, replacing its contents. A buffer that is reused
+     * from call to call only allocates while it is still growing.
+     */
+    inline void copy_to(std::vector<double>& buffer) const { buffer.assign(begin(), end()); };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSCOLUMNVIEW_H
@@ -0,0 +1,250 @@
+#include "UCSDecompressingByteSource.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef UCS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef UCS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using string = std::string;
+
+namespace
+{
+    const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+    const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+    const size_t READ_ALL_BLOCK = 1 << 20;
+}
+
+/**
+ * Opens a compressed file for reading.
+ *
+ * @param path        File to read
+ * @param compression Its format, as returned by detect_compression(); must not be compression_t::none
+ * @throws std::runtime_error if the file cannot be opened, or this build cannot read the format
+ */
+UCSDecompressingByteSource::UCSDecompressingByteSource(const string &path, compression_t compression)
+    : m_compression(compression), m_path(path)
+{
+    switch (compression)
+    {
+        case compression_t::gzip:
+#ifdef UCS_HAVE_ZLIB
+            m_gzip = gzopen(path.c_str(), "rb");
+
+            if (m_gzip == nullptr)
+                throw std::runtime_error("Could not open " + path);
+
+            gzbuffer(m_gzip, 1 << 17);
+            return;
+#else
+            throw std::runtime_error(path + " is gzip-compressed, but this build has no zlib support");
+#endif
+
+        case compression_t::zstd:
+#ifdef UCS_HAVE_ZSTD
+            m_file = std::fopen(path.c_str(), "rb");
+
+            if (m_file == nullptr)
+                throw std::runtime_error("Could not open " + path);
+
+            m_zstd = ZSTD_createDCtx();
+            m_input.resize(ZSTD_DStreamInSize());
+            return;
+#else
+            throw std::runtime_error(path + " is zstd-compressed, but this build has no zstd support");
+#endif
+
+        case compression_t::none:
+            break;
+    }
+
+    throw std::runtime_error(path + " is not compressed");
+}
+
+UCSDecompressingByteSource::~UCSDecompressingByteSource()
+{
+#ifdef UCS_HAVE_ZLIB
+    if (m_gzip != nullptr)
+        gzclose(m_gzip);
+#endif
+
+#ifdef UCS_HAVE_ZSTD
+    if (m_zstd != nullptr)
+        ZSTD_freeDCtx(m_zstd);
+#endif
+
+    if (m_file != nullptr)
+        std::fclose(m_file);
+}
+
+/**
+ * Fills buffer with size decompressed bytes, or with what is left at the end of the data. Called
+ * by csv.h, on its reader thread; like fread(), it only comes up short at the end.
+ *
+ * Before a full buffer is handed out, the data after it is decompressed ahead into m_lookahead.
+ * The last block is thus only returned once decompress() has reached the end of the stream and
+ * checked that it ended cleanly, so a truncated file raises its error before csv.h gets to parse
+ * the partial line it ends with.
+ *
+ * @return Number of bytes written; 0 once the end of the data has been reached
+ * @throws std::runtime_error if the compressed data is corrupt or truncated
+ */
+int UCSDecompressingByteSource::read(char* buffer, int size)
+{
+    int count = static_cast<int>(std::min(m_lookahead.size(), static_cast<size_t>(size)));
+
+    std::memcpy(buffer, m_lookahead.data(), static_cast<size_t>(count));
+    m_lookahead.erase(0, static_cast<size_t>(count));
+
+    while (count < size)
+    {
+        int decompressed = decompress(buffer + count, size - count);
+
+        // The end of the data; decompress() has checked that the stream is complete.
+        if (decompressed == 0)
+            return count;
+
+        count += decompressed;
+    }
+
+    if (m_lookahead.empty())
+    {
+        m_lookahead.resize(static_cast<size_t>(size));
+        m_lookahead.resize(static_cast<size_t>(decompress(&m_lookahead[0], size)));
+    }
+
+    return count;
+}
+
+/**
+ * Decompresses up to size bytes into buffer; fewer may come out even before the end of the data.
+ *
+ * @return Number of bytes written; 0 once the end of the data has been reached
+ * @throws std::runtime_error if the compressed data is corrupt or truncated
+ */
+int UCSDecompressingByteSource::decompress(char* buffer, int size)
+{
+#ifdef UCS_HAVE_ZLIB
+    if (m_compression == compression_t::gzip)
+    {
+        int count = gzread(m_gzip, buffer, static_cast<unsigned>(size));
+
+        int error = Z_OK;
+        const char* message = count <= 0 ? gzerror(m_gzip, &error) : nullptr;
+
+        // gzread() reports a file cut short in mid-stream as a plain end of file; only
+        // gzerror() tells the two apart. Its message already starts with the path.
+        if (count < 0 || error == Z_BUF_ERROR)
+            throw std::runtime_error(string("Could not decompress ") + message);
+
+        return count;
+    }
+#endif
+
+    return read_zstd(buffer, size);
+}
+
+/**
+ * zstd counterpart of decompress(). Keeps feeding compressed blocks to the decoder until it has
+ * produced at least one byte or the file ends; concatenated frames are decoded one after the other.
+ * A file that ends inside a frame is reported as truncated.
+ */
+int UCSDecompressingByteSource::read_zstd(char* buffer, int size)
+{
+#ifdef UCS_HAVE_ZSTD
+    ZSTD_outBuffer output = {buffer, static_cast<size_t>(size), 0};
+
+    while (output.pos == 0)
+    {
+        if (m_input_position == m_input_size)
+        {
+            m_input_size = std::fread(m_input.data(), 1, m_input.size(), m_file);
+            m_input_position = 0;
+
+            if (m_input_size == 0)
+            {
+                if (std::ferror(m_file))
+                    throw std::runtime_error("Could not read " + m_path);
+
+                // The decoder still expects input unless the last frame was completed.
+                if (m_zstd_pending != 0)
+                    throw std::runtime_error("Could not decompress " + m_path + ": the file is truncated");
+
+                break;
+            }
+        }
+
+        ZSTD_inBuffer input = {m_input.data(), m_input_size, m_input_position};
+        size_t result = ZSTD_decompressStream(m_zstd, &output, &input);
+
+        if (ZSTD_isError(result))
+            throw std::runtime_error("Could not decompress " + m_path + ": " + ZSTD_getErrorName(result));
+
+        m_zstd_pending = result;
+
+        m_input_position = input.pos;
+    }
+
+    return static_cast<int>(output.pos);
+#else
+    (void) buffer;
+    (void) size;
+    return 0;
+#endif
+}
+
+/**
+ * Recognises a compressed file by its magic number.
+ *
+ * @return compression_t::none for plain (or unreadable) files
+ */
+compression_t UCSDecompressingByteSource::detect_compression(const string &path)
+{
+    unsigned char magic[4] = {};
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+
+    if (file == nullptr)
+        return compression_t::none;
+
+    size_t length = std::fread(magic, 1, sizeof(magic), file);
+    std::fclose(file);
+
+    if (length >= sizeof(GZIP_MAGIC) && std::memcmp(magic, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0)
+        return compression_t::gzip;
+
+    if (length >= sizeof(ZSTD_MAGIC) && std::memcmp(magic, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0)
+        return compression_t::zstd;
+
+    return compression_t::none;
+}
+
+/**
+ * Decompresses a whole file into memory, for the ingest paths that need the complete text at once.
+ *
+ * @throws std::runtime_error as the constructor and read() do, including for truncated files
+ */
+string UCSDecompressingByteSource::read_all(const string &path, compression_t compression)
+{
+    UCSDecompressingByteSource source(path, compression);
+    string contents;
+    size_t length = 0;
+
+    for (;;)
+    {
+        contents.resize(length + READ_ALL_BLOCK);
+        int count = source.read(&contents[length], static_cast<int>(READ_ALL_BLOCK));
+
+        if (count == 0)
+            break;
+
+        length += static_cast<size_t>(count);
+    }
+
+    contents.resize(length);
+    return contents;
+}
@@ -0,0 +1,60 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSDECOMPRESSINGBYTESOURCE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSDECOMPRESSINGBYTESOURCE_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "include/csv.h"
+
+struct gzFile_s;
+struct ZSTD_DCtx_s;
+
+/**
+ * Compression formats an input file can be stored in.
+ */
+enum class compression_t {
+    none,
+    gzip, /*!< .gz, read through zlib (builds with UCS_HAVE_ZLIB) */
+    zstd  /*!< .zst, read through libzstd (builds with UCS_HAVE_ZSTD) */
+};
+
+/**
+ * csv.h byte source that decompresses a .gz or .zst file while it is being read. It plugs into
+ * io::LineReader / io::CSVReader in place of their plain file source; since csv.h fetches the
+ * next block on its own reader thread while the current one is parsed, decompression runs in
+ * the background, alongside parsing.
+ *
+ * The format is recognised from the first bytes of the file, not from its name.
+ */
+class UCSDecompressingByteSource : public io::ByteSourceBase
+{
+private:
+    compression_t m_compression;
+    std::string m_path; /*!< Used for error messages only */
+    gzFile_s* m_gzip = nullptr; /*!< zlib stream (gzip files) */
+    std::FILE* m_file = nullptr; /*!< Compressed file (zstd files) */
+    ZSTD_DCtx_s* m_zstd = nullptr; /*!< zstd decompression context (zstd files) */
+    std::vector<char> m_input; /*!< Compressed bytes read from m_file but not decompressed yet */
+    size_t m_input_position = 0; /*!< First byte of m_input not consumed yet */
+    size_t m_input_size = 0; /*!< Number of valid bytes in m_input */
+    size_t m_zstd_pending = 0; /*!< Last ZSTD_decompressStream() result; 0 only at the end of a frame */
+    std::string m_lookahead; /*!< Decompressed bytes not handed out yet, read ahead to find the end of the data in time */
+
+    int decompress(char* buffer, int size);
+    int read_zstd(char* buffer, int size);
+public:
+    UCSDecompressingByteSource(const std::string &path, compression_t compression);
+    ~UCSDecompressingByteSource() override;
+
+    UCSDecompressingByteSource(const UCSDecompressingByteSource&) = delete;
+    UCSDecompressingByteSource& operator=(const UCSDecompressingByteSource&) = delete;
+
+    int read(char* buffer, int size) override;
+
+    static compression_t detect_compression(const std::string &path);
+    static std::string read_all(const std::string &path, compression_t compression);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSDECOMPRESSINGBYTESOURCE_H
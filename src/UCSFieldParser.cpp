@@ -0,0 +1,285 @@
+#include "UCSFieldParser.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+    inline bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool is_space(char c)
+    {
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+}
+
+/**
+ * Checks that a UCS numeric field such as 39.4, "\"39.4\"", 39,112.3 or -1.5e3 is well-formed and
+ * copies the number in it, without quotes and thousands separators, to buf.
+ *
+ * Accepted, in order: optional whitespace, an optional pair of double quotes, an optional sign,
+ * integer digits (commas allowed between them as thousands separators), an optional fraction,
+ * and an optional exponent. At least one digit is required before the exponent.
+ *
+ * @param text   The field, as tokenized
+ * @param buf    Receives the number in std::from_chars syntax; holds MAX_NUMBER_LENGTH characters
+ * @param length Receives the length of the number in buf
+ * @return field_parse_error_t::none if the field is well-formed, otherwise the reason it is not
+ */
+field_parse_error_t UCSFieldParser::scan(std::string_view text, char* buf, size_t &length)
+{
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
+
+    while (!text.empty() && is_space(text.back()))
+        text.remove_suffix(1);
+
+    bool opening_quote = !text.empty() && text.front() == '"';
+
+    if (opening_quote)
+        text.remove_prefix(1);
+
+    bool closing_quote = !text.empty() && text.back() == '"';
+
+    if (closing_quote)
+        text.remove_suffix(1);
+
+    if (opening_quote != closing_quote)
+        return field_parse_error_t::unbalanced_quote;
+
+    if (text.empty())
+        return field_parse_error_t::empty;
+
+    length = 0;
+    size_t i = 0;
+    bool mantissa_digits = false;
+
+    auto append = [&](char c) {
+        if (length == MAX_NUMBER_LENGTH)
+            return false;
+
+        buf[length++] = c;
+        return true;
+    };
+
+    // Sign. std::from_chars accepts '-' but not '+'.
+    if (text[i] == '+' || text[i] == '-')
+    {
+        if (text[i] == '-')
+            append('-');
+
+        ++i;
+    }
+
+    // Integer part, with thousands separators.
+    for (; i < text.size() && (is_digit(text[i]) || (text[i] == ',' && mantissa_digits)); ++i)
+    {
+        if (text[i] == ',')
+            continue;
+
+        if (!append(text[i]))
+            return field_parse_error_t::too_long;
+
+        mantissa_digits = true;
+    }
+
+    // Fraction.
+    if (i < text.size() && text[i] == '.')
+    {
+        if (!append('.'))
+            return field_parse_error_t::too_long;
+
+        for (++i; i < text.size() && is_digit(text[i]); ++i)
+        {
+            if (!append(text[i]))
+                return field_parse_error_t::too_long;
+
+            mantissa_digits = true;
+        }
+    }
+
+    if (!mantissa_digits)
+        return (i < text.size() && !is_digit(text[i]) && text[i] != 'e' && text[i] != 'E' && text[i] != '.')
+               ? field_parse_error_t::invalid_character : field_parse_error_t::malformed_number;
+
+    // Exponent.
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        bool exponent_digits = false;
+
+        if (!append('e'))
+            return field_parse_error_t::too_long;
+
+        ++i;
+
+        if (i < text.size() && (text[i] == '+' || text[i] == '-'))
+        {
+            if (!append(text[i]))
+                return field_parse_error_t::too_long;
+
+            ++i;
+        }
+
+        for (; i < text.size() && is_digit(text[i]); ++i)
+        {
+            if (!append(text[i]))
+                return field_parse_error_t::too_long;
+
+            exponent_digits = true;
+        }
+
+        if (!exponent_digits)
+            return field_parse_error_t::malformed_number;
+    }
+
+    if (i != text.size())
+    {
+        char c = text[i];
+        return (c == '.' || c == ',' || c == '+' || c == '-' || c == 'e' || c == 'E' || is_digit(c))
+               ? field_parse_error_t::malformed_number : field_parse_error_t::invalid_character;
+    }
+
+    return field_parse_error_t::none;
+}
+
+/**
+ * Converts a UCS numeric field such as 39.4, "\"39.4\"", 39,112.3 or -1.5e3 (see scan() for the
+ * accepted syntax).
+ *
+ * @param text  The field, as tokenized
+ * @param value Receives the number; untouched on failure
+ * @return field_parse_error_t::none on success, otherwise the reason for the failure
+ */
+field_parse_error_t UCSFieldParser::parse(std::string_view text, double &value)
+{
+    char buf[MAX_NUMBER_LENGTH];
+    size_t length;
+    field_parse_error_t error = scan(text, buf, length);
+
+    if (error != field_parse_error_t::none)
+        return error;
+
+    double result;
+    std::from_chars_result conversion = std::from_chars(buf, buf + length, result);
+
+    if (conversion.ec == std::errc::result_out_of_range)
+        return field_parse_error_t::out_of_range;
+
+    if (conversion.ec != std::errc() || conversion.ptr != buf + length)
+        return field_parse_error_t::malformed_number;
+
+    value = result;
+    return field_parse_error_t::none;
+}
+
+const char* UCSFieldParser::error_name(field_parse_error_t error)
+{
+    switch (error)
+    {
+        case field_parse_error_t::none: return "no error";
+        case field_parse_error_t::empty: return "empty field";
+        case field_parse_error_t::unbalanced_quote: return "unbalanced quote";
+        case field_parse_error_t::invalid_character: return "invalid character";
+        case field_parse_error_t::malformed_number: return "malformed number";
+        case field_parse_error_t::too_long: return "number too long";
+        case field_parse_error_t::out_of_range: return "number out of range";
+    }
+
+    return "unknown error";
+}
+
+/**
+ * Checks a field exactly as parse() does, for columns whose values are not needed right now.
+ * Only fields with an exponent are converted: without one, a number short enough for the buffer
+ * is always in range for a double.
+ */
+field_parse_error_t UCSFieldParser::validate(std::string_view text)
+{
+    char buf[MAX_NUMBER_LENGTH];
+    size_t length;
+    field_parse_error_t error = scan(text, buf, length);
+
+    if (error != field_parse_error_t::none || std::memchr(buf, 'e', length) == nullptr)
+        return error;
+
+    double value;
+    return parse(text, value);
+}
+
+/**
+ * Parses a field and records a diagnostic if that fails.
+ *
+ * @return Whether the field was parsed
+ */
+bool UCSFieldParser::parse_field(std::string_view text, double &value, int row_id, const char* field_name)
+{
+    return record(parse(text, value), text, row_id, field_name);
+}
+
+/**
+ * Validates a field (see validate()) and records a diagnostic if that fails.
+ *
+ * @return Whether the field is well-formed
+ */
+bool UCSFieldParser::validate_field(std::string_view text, int row_id, const char* field_name)
+{
+    return record(validate(text), text, row_id, field_name);
+}
+
+/**
+ * Records a diagnostic for a failed field.
+ *
+ * @return Whether error is field_parse_error_t::none
+ */
+bool UCSFieldParser::record(field_parse_error_t error, std::string_view text, int row_id, const char* field_name)
+{
+    if (error == field_parse_error_t::none)
+        return true;
+
+    if (m_failure_count++ < m_diagnostic_limit)
+        m_diagnostics.push_back({row_id, field_name, error, std::string(text)});
+
+    return false;
+}
+
+/**
+ * Takes over the diagnostics of a parser that worked on a later chunk of the same file.
+ *
+ * @param chunk         Parser of the chunk
+ * @param row_id_offset Number of rows before the chunk, added to its chunk-local row ids
+ */
+void UCSFieldParser::merge(const UCSFieldParser &chunk, int row_id_offset)
+{
+    for (const field_diagnostic_t& diagnostic : chunk.m_diagnostics)
+    {
+        if (m_diagnostics.size() == m_diagnostic_limit)
+            break;
+
+        m_diagnostics.push_back(diagnostic);
+        m_diagnostics.back().row_id += row_id_offset;
+    }
+
+    m_failure_count += chunk.m_failure_count;
+}
+
+/**
+ * Writes the first limit diagnostics, one per line, followed by a count of the rest.
+ */
+void UCSFieldParser::report(std::ostream &out, size_t limit) const
+{
+    for (size_t i = 0; i < m_diagnostics.size() && i < limit; ++i)
+    {
+        const field_diagnostic_t& diagnostic = m_diagnostics[i];
+        out << "Something went wrong at sat " << diagnostic.row_id << ": " << diagnostic.field_name << " \""
+            << diagnostic.text << "\" (" << error_name(diagnostic.error) << ")" << std::endl;
+    }
+
+    size_t reported = std::min(limit, m_diagnostics.size());
+
+    if (m_failure_count > reported)
+        out << "... and " << (m_failure_count - reported) << " more malformed field(s)" << std::endl;
+}
@@ -0,0 +1,68 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSFIELDPARSER_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSFIELDPARSER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Why a UCS numeric field could not be converted.
+ */
+enum class field_parse_error_t {
+    none,
+    empty,             /*!< Nothing but whitespace and quotes */
+    unbalanced_quote,  /*!< Opening quote without a closing one, or the other way around */
+    invalid_character, /*!< A character that cannot be part of a number */
+    malformed_number,  /*!< Number characters in an impossible order, e.g. "1.2.3" or "e5" */
+    too_long,          /*!< More significant characters than any UCS value has */
+    out_of_range       /*!< Does not fit in a double */
+};
+
+/**
+ * One field that failed to parse.
+ */
+struct field_diagnostic_t {
+    int row_id; /*!< Row number in the UCS DB */
+    const char* field_name; /*!< Column the field came from */
+    field_parse_error_t error;
+    std::string text; /*!< The field as found in the file */
+};
+
+/**
+ * Exception-free parser for UCS numeric fields. Surrounding quotes and thousands separators are
+ * handled inline while the field is validated in a single pass; the cleaned-up number is
+ * assembled in a stack buffer and converted with std::from_chars, so a successful parse never
+ * allocates. Fields of columns that are not needed can be validated without being converted.
+ * Failures come back as a field_parse_error_t and, through parse_field() and validate_field(),
+ * are collected as diagnostics for the caller to report once loading has finished.
+ */
+class UCSFieldParser
+{
+private:
+    std::vector<field_diagnostic_t> m_diagnostics; /*!< Failures recorded by parse_field() and validate_field(), up to m_diagnostic_limit */
+    size_t m_diagnostic_limit = SIZE_MAX; /*!< Number of failures whose details are kept */
+    size_t m_failure_count = 0; /*!< Number of failures, including the ones whose details were not kept */
+
+    static const size_t MAX_NUMBER_LENGTH = 64;
+
+    static field_parse_error_t scan(std::string_view text, char* buf, size_t &length);
+    bool record(field_parse_error_t error, std::string_view text, int row_id, const char* field_name);
+public:
+    static field_parse_error_t parse(std::string_view text, double &value);
+    static field_parse_error_t validate(std::string_view text);
+    static const char* error_name(field_parse_error_t error);
+
+    bool parse_field(std::string_view text, double &value, int row_id, const char* field_name);
+    bool validate_field(std::string_view text, int row_id, const char* field_name);
+    void merge(const UCSFieldParser &chunk, int row_id_offset);
+
+    inline void set_diagnostic_limit(size_t limit) { m_diagnostic_limit = limit; };
+    inline const std::vector<field_diagnostic_t>& get_diagnostics() const { return m_diagnostics; };
+    inline size_t get_failure_count() const { return m_failure_count; };
+    void report(std::ostream &out, size_t limit) const;
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSFIELDPARSER_H
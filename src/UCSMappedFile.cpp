@@ -0,0 +1,61 @@
+#include "UCSMappedFile.h"
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using string = std::string;
+
+/**
+ * Opens the file at path and maps it into memory. The kernel is told that the mapping
+ * will be read front to back so it can read ahead aggressively.
+ *
+ * @param path Path of the file to map
+ * @throws std::runtime_error if the file cannot be opened, inspected or mapped
+ */
+UCSMappedFile::UCSMappedFile(const string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+
+    struct stat file_stat {};
+
+    if (fstat(fd, &file_stat) == -1)
+    {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Could not stat " + path + ": " + std::strerror(error));
+    }
+
+    m_size = static_cast<size_t>(file_stat.st_size);
+
+    // mmap() refuses zero-length mappings; an empty file is simply an empty view.
+    if (m_size != 0)
+    {
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Could not map " + path + ": " + std::strerror(error));
+        }
+
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(mapping);
+    }
+
+    // The mapping keeps its own reference to the file.
+    close(fd);
+}
+
+UCSMappedFile::~UCSMappedFile()
+{
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+}
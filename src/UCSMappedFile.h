@@ -0,0 +1,28 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSMAPPEDFILE_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSMAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only memory mapping of a whole file. The mapping lives exactly as long as this
+ * object, so any std::string_view handed out by view() must not outlive it.
+ */
+class UCSMappedFile
+{
+private:
+    const char* m_data = nullptr; /*!< First byte of the mapping (nullptr for empty files) */
+    size_t m_size = 0; /*!< Size of the mapping in bytes */
+public:
+    explicit UCSMappedFile(const std::string &path);
+    ~UCSMappedFile();
+
+    UCSMappedFile(const UCSMappedFile&) = delete;
+    UCSMappedFile& operator=(const UCSMappedFile&) = delete;
+
+    inline std::string_view view() const { return {m_data, m_size}; };
+    inline size_t size() const { return m_size; };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSMAPPEDFILE_H
@@ -0,0 +1,276 @@
+#include "UCSRowTokenizer.h"
+#include "include/csv.h"
+
+using string = std::string;
+
+namespace
+{
+    const int UCS_FIELD_COUNT = 12;
+    const int UCS_REQUIRED_FIELD_COUNT = 8; /* The first fields must be in the header; the rest are optional */
+
+    /* Column names and the candidate_satellite_view_t member each one is stored in. The order
+     * matches the read_header() call in the csv.h ingest path. */
+    const char* const UCS_FIELD_NAMES[UCS_FIELD_COUNT] = {
+            "Class of Orbit", "Longitude of GEO (degrees)", "Perigee (km)", "Apogee (km)", "Eccentricity",
+            "Inclination (degrees)", "Period (minutes)", "Launch Mass (kg.)",
+            "Country of Operator/Owner", "Operator/Owner", "Users", "Purpose"
+    };
+
+    std::string_view candidate_satellite_view_t::* const UCS_FIELD_MEMBERS[UCS_FIELD_COUNT] = {
+            &candidate_satellite_view_t::p_orbit_class, &candidate_satellite_view_t::p_longitude,
+            &candidate_satellite_view_t::p_perigee, &candidate_satellite_view_t::p_apogee,
+            &candidate_satellite_view_t::p_eccentricity, &candidate_satellite_view_t::p_inclination,
+            &candidate_satellite_view_t::p_period, &candidate_satellite_view_t::p_launch_mass,
+            &candidate_satellite_view_t::p_country, &candidate_satellite_view_t::p_operator,
+            &candidate_satellite_view_t::p_users, &candidate_satellite_view_t::p_purpose
+    };
+
+    /**
+     * Removes leading and trailing spaces from a field, like io::trim_chars<' '>.
+     */
+    std::string_view trim_field(std::string_view field)
+    {
+        while (!field.empty() && field.front() == ' ')
+            field.remove_prefix(1);
+
+        while (!field.empty() && field.back() == ' ')
+            field.remove_suffix(1);
+
+        return field;
+    }
+
+    /**
+     * Cuts the next tab-delimited field off the front of line. Returns false once the line
+     * has no fields left.
+     */
+    bool chop_next_field(std::string_view &line, bool &exhausted, std::string_view &field)
+    {
+        if (exhausted)
+            return false;
+
+        size_t tab = line.find('\t');
+
+        if (tab == std::string_view::npos)
+        {
+            field = line;
+            exhausted = true;
+        } else {
+            field = line.substr(0, tab);
+            line.remove_prefix(tab + 1);
+        }
+
+        return true;
+    }
+}
+
+/**
+ * @param data      Contents of a UCS database file; must outlive the tokenizer and every row it returns
+ * @param file_name Name reported in parse errors
+ */
+UCSRowTokenizer::UCSRowTokenizer(std::string_view data, const string &file_name)
+    : m_data(data), m_file_name(file_name)
+{
+    // Ignore UTF-8 BOM
+    if (m_data.size() >= 3 && m_data.substr(0, 3) == "\xEF\xBB\xBF")
+        m_position = 3;
+}
+
+/**
+ * Makes a tokenizer for one chunk of a file whose header has already been read by another
+ * tokenizer, so that chunks can be tokenized on separate threads.
+ *
+ * @param header_source Tokenizer that read the header; its column layout and file name are copied
+ * @param chunk         Whole lines of the same file, as handed out by split_remaining()
+ * @param lines_before  Number of lines in the file before the chunk, so errors report absolute line numbers
+ */
+UCSRowTokenizer::UCSRowTokenizer(const UCSRowTokenizer &header_source, std::string_view chunk, unsigned lines_before)
+    : m_data(chunk), m_file_line(lines_before), m_file_name(header_source.m_file_name),
+      m_column_slots(header_source.m_column_slots), m_header_line(header_source.m_header_line)
+{
+}
+
+/**
+ * Hands out the next physical line, without its line break.
+ */
+bool UCSRowTokenizer::next_line(std::string_view &line)
+{
+    if (m_position >= m_data.size())
+        return false;
+
+    ++m_file_line;
+
+    size_t line_end = m_data.find('\n', m_position);
+
+    if (line_end == std::string_view::npos)
+        line_end = m_data.size(); // some files are missing the newline at the end of the last line
+
+    line = m_data.substr(m_position, line_end - m_position);
+    m_position = line_end + 1;
+
+    // handle windows \r\n-line breaks
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    return true;
+}
+
+/**
+ * Reads the first non-comment line and works out which column feeds which field.
+ *
+ * @throws io::error::header_missing, io::error::duplicated_column_in_header or io::error::missing_column_in_header
+ */
+void UCSRowTokenizer::read_header()
+{
+    std::string_view line;
+
+    do {
+        if (!next_line(line))
+        {
+            io::error::header_missing err;
+            err.set_file_name(m_file_name.c_str());
+            throw err;
+        }
+    } while (!line.empty() && line.front() == '#');
+
+    m_header_line = line;
+
+    bool found[UCS_FIELD_COUNT] = {};
+    bool exhausted = false;
+    std::string_view column;
+
+    m_column_slots.clear();
+
+    while (chop_next_field(line, exhausted, column))
+    {
+        column = trim_field(column);
+        int slot = -1;
+
+        for (int i = 0; i < UCS_FIELD_COUNT; ++i)
+        {
+            if (column != UCS_FIELD_NAMES[i])
+                continue;
+
+            if (found[i])
+            {
+                io::error::duplicated_column_in_header err;
+                err.set_column_name(UCS_FIELD_NAMES[i]);
+                err.set_file_name(m_file_name.c_str());
+                throw err;
+            }
+
+            found[i] = true;
+            slot = i;
+            break;
+        }
+
+        m_column_slots.push_back(slot);
+    }
+
+    for (int i = 0; i < UCS_REQUIRED_FIELD_COUNT; ++i)
+    {
+        if (!found[i])
+        {
+            io::error::missing_column_in_header err;
+            err.set_column_name(UCS_FIELD_NAMES[i]);
+            err.set_file_name(m_file_name.c_str());
+            throw err;
+        }
+    }
+}
+
+/**
+ * Tokenizes the next data row into row. Only the span members are written; the caller
+ * fills in the row id and the eccentricity qualifier.
+ *
+ * @return false once the end of the data has been reached
+ * @throws io::error::too_few_columns or io::error::too_many_columns
+ */
+bool UCSRowTokenizer::read_row(candidate_satellite_view_t &row)
+{
+    std::string_view line;
+
+    if (!next_data_line(line))
+        return false;
+
+    split_row(line, row);
+    return true;
+}
+
+/**
+ * Hands out the next line that is not a comment, without splitting it. Together with
+ * split_row() this lets a caller inspect or reject raw lines before they are tokenized.
+ *
+ * @return false once the end of the data has been reached
+ */
+bool UCSRowTokenizer::next_data_line(std::string_view &line)
+{
+    do {
+        if (!next_line(line))
+            return false;
+    } while (!line.empty() && line.front() == '#');
+
+    return true;
+}
+
+/**
+ * Splits one data line into the fields named in the header. Errors are reported against the
+ * line most recently returned by next_data_line().
+ *
+ * @throws io::error::too_few_columns or io::error::too_many_columns
+ */
+void UCSRowTokenizer::split_row(std::string_view line, candidate_satellite_view_t &row) const
+{
+    bool exhausted = false;
+    std::string_view field;
+
+    for (int slot : m_column_slots)
+    {
+        if (!chop_next_field(line, exhausted, field))
+        {
+            io::error::too_few_columns err;
+            err.set_file_name(m_file_name.c_str());
+            err.set_file_line(m_file_line);
+            throw err;
+        }
+
+        if (slot != -1)
+            row.*UCS_FIELD_MEMBERS[slot] = trim_field(field);
+    }
+
+    if (!exhausted)
+    {
+        io::error::too_many_columns err;
+        err.set_file_name(m_file_name.c_str());
+        err.set_file_line(m_file_line);
+        throw err;
+    }
+}
+
+/**
+ * Cuts the data that has not been consumed yet into at most chunk_count pieces of roughly equal
+ * size. Every piece but the last ends right after a line break, so no line is ever split.
+ *
+ * @param chunk_count Number of pieces wanted
+ * @return The pieces, in file order; empty pieces are left out
+ */
+std::vector<std::string_view> UCSRowTokenizer::split_remaining(size_t chunk_count) const
+{
+    std::vector<std::string_view> chunks;
+    std::string_view rest = m_position < m_data.size() ? m_data.substr(m_position) : std::string_view();
+
+    if (chunk_count == 0)
+        chunk_count = 1;
+
+    size_t target_size = rest.size() / chunk_count + 1;
+
+    while (!rest.empty())
+    {
+        size_t line_end = (rest.size() > target_size) ? rest.find('\n', target_size - 1) : std::string_view::npos;
+        size_t chunk_size = (line_end == std::string_view::npos) ? rest.size() : line_end + 1;
+
+        chunks.push_back(rest.substr(0, chunk_size));
+        rest.remove_prefix(chunk_size);
+    }
+
+    return chunks;
+}
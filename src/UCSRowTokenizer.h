@@ -0,0 +1,45 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSROWTOKENIZER_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSROWTOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "candidate_satellite_view_t.h"
+
+/**
+ * Splits an in-memory, tab-separated UCS database into rows without copying anything.
+ * It follows the same rules as the io::CSVReader configuration used by UCSSatelliteDatabase:
+ * fields are trimmed of spaces, quotes are left untouched, lines starting with '#' are skipped,
+ * columns that are not needed are ignored, and malformed lines raise the matching io::error.
+ */
+class UCSRowTokenizer
+{
+private:
+    std::string_view m_data; /*!< Whole file contents */
+    size_t m_position = 0; /*!< Offset of the first byte not yet consumed */
+    unsigned m_file_line = 0; /*!< Number of the line most recently returned */
+    std::string m_file_name; /*!< Used for error messages only */
+    std::vector<int> m_column_slots; /*!< For each column in the header, the field it feeds (-1 if ignored) */
+    std::string_view m_header_line; /*!< Header line as found in the data */
+
+    bool next_line(std::string_view &line);
+public:
+    UCSRowTokenizer(std::string_view data, const std::string &file_name);
+    UCSRowTokenizer(const UCSRowTokenizer &header_source, std::string_view chunk, unsigned lines_before);
+
+    void read_header();
+    bool read_row(candidate_satellite_view_t &row);
+
+    bool next_data_line(std::string_view &line);
+    void split_row(std::string_view line, candidate_satellite_view_t &row) const;
+
+    std::vector<std::string_view> split_remaining(size_t chunk_count) const;
+
+    inline std::string_view get_header_line() const { return m_header_line; };
+
+    inline unsigned get_file_line() const { return m_file_line; };
+    inline void set_file_line(unsigned file_line) { m_file_line = file_line; }; /*!< For lines passed to split_row() from another reader */
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSROWTOKENIZER_H
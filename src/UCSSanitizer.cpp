@@ -0,0 +1,137 @@
+#include "UCSSanitizer.h"
+#include "UCSFieldParser.h"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+
+const char UCS_DELIMITER = '\t';
+
+/**
+ * @param header_line Header of the raw database; its delimiter count is the reference for every row
+ * @param output_path Where to write the sanitized copy (empty for none)
+ * @param messages    Where rejected lines and the final report are written
+ * @throws std::runtime_error if the sanitized copy cannot be created
+ */
+UCSSanitizer::UCSSanitizer(std::string_view header_line, const std::string &output_path, std::ostream &messages)
+    : m_expected_delimiters(std::count(header_line.begin(), header_line.end(), UCS_DELIMITER)), m_messages(&messages),
+      m_eccentricity_text()
+{
+    if (output_path.empty())
+        return;
+
+    m_output_file.open(output_path, std::ios::binary);
+
+    if (!m_output_file)
+        throw std::runtime_error("Could not create sanitized copy " + output_path);
+
+    m_output_file << header_line << '\n';
+    m_output = &m_output_file;
+}
+
+/**
+ * Chunk sanitizer: everything it would write is held back until merge().
+ *
+ * @param expected_delimiters Delimiter count of the header line
+ * @param keep_output         Whether sanitized lines are wanted at all
+ */
+UCSSanitizer::UCSSanitizer(size_t expected_delimiters, bool keep_output)
+    : m_expected_delimiters(expected_delimiters), m_messages(&m_held_messages), m_eccentricity_text()
+{
+    if (keep_output)
+        m_output = &m_held_output;
+}
+
+/**
+ * Makes a sanitizer for one chunk of the file. It applies the same checks as this one, but
+ * holds its report and its sanitized lines back until they are passed to merge().
+ */
+std::unique_ptr<UCSSanitizer> UCSSanitizer::make_chunk_sanitizer() const
+{
+    return std::unique_ptr<UCSSanitizer>(new UCSSanitizer(m_expected_delimiters, m_output != nullptr));
+}
+
+/**
+ * Emits what a chunk sanitizer held back and adds its rejection counts to this one's.
+ * Chunks must be merged in file order.
+ */
+void UCSSanitizer::merge(UCSSanitizer &chunk)
+{
+    *m_messages << chunk.m_held_messages.str();
+    m_messages->flush();
+
+    if (m_output)
+        *m_output << chunk.m_held_output.str();
+
+    m_delimiter_rejections += chunk.m_delimiter_rejections;
+    m_corruption_rejections += chunk.m_corruption_rejections;
+}
+
+/**
+ * Check 1: the line must have as many delimiters as the header.
+ *
+ * @return Whether the line passes
+ */
+bool UCSSanitizer::check_delimiters(std::string_view line, unsigned file_line)
+{
+    size_t delimiters = std::count(line.begin(), line.end(), UCS_DELIMITER);
+
+    if (delimiters == m_expected_delimiters)
+        return true;
+
+    *m_messages << "[Sanitizer] Will not include line #" << file_line << " (expected " << m_expected_delimiters
+              << " delimiters, got " << delimiters << ")" << std::endl;
+    ++m_delimiter_rejections;
+    return false;
+}
+
+/**
+ * Check 2: recomputes the eccentricity of a tokenized row. On success, row.p_eccentricity is
+ * pointed at the recomputed value (written in shortest round-trip form, so parsing it again
+ * yields the exact same double) and the line is appended to the sanitized copy.
+ *
+ * @param line      Raw line the row was tokenized from
+ * @param row       Tokenized row; its spans must point into line
+ * @param file_line Line number used in the report
+ * @return Whether the row passes
+ */
+bool UCSSanitizer::rewrite_eccentricity(std::string_view line, candidate_satellite_view_t &row, unsigned file_line)
+{
+    double period, perigee, apogee, eccentricity;
+
+    bool parsed = UCSFieldParser::parse(row.p_period, period) == field_parse_error_t::none
+                  && UCSFieldParser::parse(row.p_perigee, perigee) == field_parse_error_t::none
+                  && UCSFieldParser::parse(row.p_apogee, apogee) == field_parse_error_t::none
+                  && UCSFieldParser::parse(row.p_eccentricity, eccentricity) == field_parse_error_t::none;
+
+    if (!parsed || apogee + perigee == 0)
+    {
+        *m_messages << "[Sanitizer] Will not include line #" << file_line << " (the row is corrupt)" << std::endl;
+        ++m_corruption_rejections;
+        return false;
+    }
+
+    double new_eccentricity = (apogee - perigee) / (apogee + perigee);
+    char* text_end = std::to_chars(std::begin(m_eccentricity_text), std::end(m_eccentricity_text), new_eccentricity).ptr;
+    std::string_view new_text(m_eccentricity_text, text_end - m_eccentricity_text);
+
+    if (m_output)
+    {
+        size_t field_begin = row.p_eccentricity.data() - line.data();
+        size_t field_end = field_begin + row.p_eccentricity.size();
+
+        *m_output << line.substr(0, field_begin) << new_text << line.substr(field_end) << '\n';
+    }
+
+    row.p_eccentricity = new_text;
+    return true;
+}
+
+/**
+ * Prints how many lines each check dropped.
+ */
+void UCSSanitizer::report() const
+{
+    *m_messages << "[Sanitizer] " << m_delimiter_rejections << " line(s) skipped for a wrong delimiter count, "
+              << m_corruption_rejections << " row(s) skipped due to corruption or missing data." << std::endl;
+}
@@ -0,0 +1,53 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSSANITIZER_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSSANITIZER_H
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "candidate_satellite_view_t.h"
+
+/**
+ * Streaming, single-pass replacement for preprocess.py. Raw lines are checked as they are read:
+ *
+ *  1. a line must contain exactly as many delimiters as the header, and
+ *  2. its perigee, apogee, period and eccentricity must parse; the eccentricity is then replaced
+ *     with (apogee - perigee) / (apogee + perigee), since the published values are inconsistent.
+ *
+ * Rejected lines are reported on stdout and dropped. Accepted lines can optionally be written to
+ * a sanitized copy of the database, identical to the input except for the eccentricity column.
+ *
+ * For parallel ingest, make_chunk_sanitizer() hands out a sanitizer per chunk that holds its
+ * messages and sanitized lines back; merge() then emits them in chunk order, so the report and
+ * the sanitized copy come out exactly as a single-threaded pass would produce them.
+ */
+class UCSSanitizer
+{
+private:
+    size_t m_expected_delimiters; /*!< Number of delimiters in the header line */
+    std::ofstream m_output_file; /*!< Sanitized copy, if one was requested */
+    std::ostringstream m_held_output; /*!< Sanitized lines held back by a chunk sanitizer */
+    std::ostringstream m_held_messages; /*!< Report lines held back by a chunk sanitizer */
+    std::ostream* m_output = nullptr; /*!< Where sanitized lines go (nullptr if nowhere) */
+    std::ostream* m_messages; /*!< Where rejected lines are reported */
+    char m_eccentricity_text[32]; /*!< Text of the most recently recomputed eccentricity */
+    int m_delimiter_rejections = 0; /*!< Lines dropped by check 1 */
+    int m_corruption_rejections = 0; /*!< Lines dropped by check 2 */
+
+    UCSSanitizer(size_t expected_delimiters, bool keep_output);
+public:
+    UCSSanitizer(std::string_view header_line, const std::string &output_path, std::ostream &messages = std::cout);
+
+    std::unique_ptr<UCSSanitizer> make_chunk_sanitizer() const;
+    void merge(UCSSanitizer &chunk);
+
+    bool check_delimiters(std::string_view line, unsigned file_line);
+    bool rewrite_eccentricity(std::string_view line, candidate_satellite_view_t &row, unsigned file_line);
+
+    void report() const;
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSSANITIZER_H
@@ -0,0 +1,356 @@
+#include "UCSSatelliteColumns.h"
+#include "KeplerKernels.h"
+#include "QualificationKernels.h"
+#include "Settings.h"
+#include <algorithm>
+#include <limits>
+
+using string = std::string;
+
+namespace
+{
+    const double MISSING_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+    // Headers of the numeric fields, in the order append() parses them. Used in diagnostics.
+    const char* const NUMERIC_FIELD_NAMES[7] = {
+            "Longitude of GEO (degrees)", "Perigee (km)", "Apogee (km)", "Eccentricity",
+            "Inclination (degrees)", "Period (minutes)", "Launch Mass (kg.)"
+    };
+
+    // The numeric input columns, in the same order.
+    aligned_vector<double> UCSSatelliteColumns::* const NUMERIC_COLUMNS[7] = {
+            &UCSSatelliteColumns::longitude, &UCSSatelliteColumns::perigee, &UCSSatelliteColumns::apogee,
+            &UCSSatelliteColumns::eccentricity, &UCSSatelliteColumns::inclination, &UCSSatelliteColumns::period,
+            &UCSSatelliteColumns::launch_mass
+    };
+
+    // The input column of each categorical variable, indexed by ucs_category_t.
+    const ucs_column_set_t CATEGORY_COLUMNS[UCS_CATEGORY_COUNT] = {
+            UCS_COLUMN_ORBIT_CLASS, UCS_COLUMN_COUNTRY, UCS_COLUMN_OPERATOR, UCS_COLUMN_USERS, UCS_COLUMN_PURPOSE
+    };
+
+    /**
+     * Bit of the i-th numeric input column in a ucs_column_set_t.
+     */
+    inline ucs_column_set_t numeric_column(int i)
+    {
+        return UCS_COLUMN_LONGITUDE << i;
+    }
+}
+
+void UCSSatelliteColumns::reserve(size_t rows)
+{
+    satellite_row_id.reserve(rows);
+    snapshot_id.reserve(rows);
+
+    for (std::vector<category_code_t>& codes : category_codes)
+        codes.reserve(rows);
+
+    longitude.reserve(rows);
+    perigee.reserve(rows);
+    apogee.reserve(rows);
+    eccentricity.reserve(rows);
+    inclination.reserve(rows);
+    period.reserve(rows);
+    launch_mass.reserve(rows);
+    eligible.reserve(rows);
+    qualifying.reserve(rows);
+    parse_reason.reserve(rows);
+    kepler_x.reserve(rows);
+    kepler_y.reserve(rows);
+    kepler_mass.reserve(rows);
+    secondary_mass.reserve(rows);
+    satellite_velocity.reserve(rows);
+}
+
+/**
+ * Removes every row but keeps the allocated capacity and the category dictionaries, so the
+ * store can be refilled without allocating again.
+ */
+void UCSSatelliteColumns::clear()
+{
+    satellite_row_id.clear();
+    snapshot_id.clear();
+
+    for (std::vector<category_code_t>& codes : category_codes)
+        codes.clear();
+
+    longitude.clear();
+    perigee.clear();
+    apogee.clear();
+    eccentricity.clear();
+    inclination.clear();
+    period.clear();
+    launch_mass.clear();
+    eligible.clear();
+    qualifying.clear();
+    parse_reason.clear();
+    kepler_x.clear();
+    kepler_y.clear();
+    kepler_mass.clear();
+    secondary_mass.clear();
+    satellite_velocity.clear();
+}
+
+/**
+ * Validates the data for selected variables from the UCS Satellite Database, checks whether this
+ * satellite is qualifying and appends it as a new row.
+ *
+ * @param sat    Candidate satellite entry (candidate_satellite_t instance) to check—if check passes, the candidate is flagged as disqualified.
+ * @param parser Parser that records why a field could not be read
+ */
+void UCSSatelliteColumns::append(const candidate_satellite_t& sat, UCSFieldParser& parser)
+{
+    candidate_satellite_view_t view = {
+            sat.p_satellite_row_id, sat.p_orbit_class, sat.p_longitude, sat.p_perigee, sat.p_apogee,
+            sat.p_eccentricity, sat.p_inclination, sat.p_period, sat.p_launch_mass,
+            sat.p_country, sat.p_operator, sat.p_users, sat.p_purpose, sat.eccentricity_qualifier
+    };
+
+    append(view, parser);
+}
+
+/**
+ * Zero-copy counterpart of append(candidate_satellite_t&). The fields are parsed straight
+ * out of the spans with UCSFieldParser, so neither the stripping nor the conversion allocates.
+ *
+ * @param sat    Candidate satellite entry whose fields point into the mapped database file
+ * @param parser Parser that records why a field could not be read
+ */
+void UCSSatelliteColumns::append(const candidate_satellite_view_t& sat, UCSFieldParser& parser)
+{
+    double values[7] = {MISSING_VALUE, MISSING_VALUE, MISSING_VALUE, MISSING_VALUE, MISSING_VALUE, MISSING_VALUE, MISSING_VALUE};
+    std::string_view category_values[UCS_CATEGORY_COUNT] = {sat.p_orbit_class, sat.p_country, sat.p_operator, sat.p_users, sat.p_purpose};
+    category_code_t codes[UCS_CATEGORY_COUNT] = {};
+
+    // Code 0 (the empty string) stands in for the columns that are not materialized.
+    for (int column = 0; column < UCS_CATEGORY_COUNT; ++column)
+    {
+        if (materialized & CATEGORY_COLUMNS[column])
+            codes[column] = categories[column].intern(category_values[column]);
+    }
+
+    // If we are missing any required field, then disqualify this satellite.
+    if (sat.p_orbit_class.empty()    || sat.p_longitude.empty() || sat.p_perigee.empty() || sat.p_apogee.empty() || sat.p_eccentricity.empty()
+        || sat.p_inclination.empty()    || sat.p_period.empty()    || sat.p_launch_mass.empty())
+    {
+        push_row(sat.p_satellite_row_id, codes, values, DISQ_REASON_MISSING_PARAMETER, sat.eccentricity_qualifier);
+        return;
+    }
+
+    /**
+     * Unfortunately, the UCS CSV file is not very program-friendly: numbers may be quoted and
+     * carry thousands separators. UCSFieldParser deals with both while parsing.
+     *
+     * Columns that are not materialized are only validated, so that a row qualifies exactly
+     * as it would with every column converted; their values stay NaN.
+     */
+    std::string_view fields[7] = {sat.p_longitude, sat.p_perigee, sat.p_apogee, sat.p_eccentricity, sat.p_inclination, sat.p_period, sat.p_launch_mass};
+
+    for (int i = 0; i < 7; ++i)
+    {
+        bool wanted = (materialized & numeric_column(i)) != 0;
+
+        if (wanted ? parser.parse_field(fields[i], values[i], sat.p_satellite_row_id, NUMERIC_FIELD_NAMES[i])
+                   : parser.validate_field(fields[i], sat.p_satellite_row_id, NUMERIC_FIELD_NAMES[i]))
+            continue;
+
+        std::fill(std::begin(values), std::end(values), MISSING_VALUE);
+        push_row(sat.p_satellite_row_id, codes, values, DISQ_REASON_MALFORMED_PARAMETER, sat.eccentricity_qualifier);
+        return;
+    }
+
+    push_row(sat.p_satellite_row_id, codes, values, 0, sat.eccentricity_qualifier);
+}
+
+/**
+ * Overwrites some input columns of the rows [first_row, first_row + source.size()) with the
+ * values of a store that was parsed from the same input with those columns materialized.
+ *
+ * @param source    Store holding the columns
+ * @param first_row Row of this store that corresponds to the first row of source
+ * @param columns   Input columns to copy
+ */
+void UCSSatelliteColumns::copy_columns(const UCSSatelliteColumns& source, size_t first_row, ucs_column_set_t columns)
+{
+    for (int column = 0; column < UCS_CATEGORY_COUNT; ++column)
+    {
+        if (!(columns & CATEGORY_COLUMNS[column]))
+            continue;
+
+        std::vector<category_code_t> translation = categories[column].merge(source.categories[column]);
+        auto target = category_codes[column].begin() + first_row;
+
+        for (category_code_t code : source.category_codes[column])
+            *target++ = translation[code];
+    }
+
+    for (int i = 0; i < 7; ++i)
+    {
+        if (!(columns & numeric_column(i)))
+            continue;
+
+        const aligned_vector<double>& from = source.*NUMERIC_COLUMNS[i];
+        std::copy(from.begin(), from.end(), (this->*NUMERIC_COLUMNS[i]).begin() + first_row);
+    }
+}
+
+/**
+ * Appends every row of a column store that was parsed from a later chunk of the same file.
+ *
+ * @param chunk         Column store of the chunk, with row ids counted from 1
+ * @param row_id_offset Number of rows before the chunk, added to its row ids
+ */
+void UCSSatelliteColumns::append_chunk(UCSSatelliteColumns& chunk, int row_id_offset)
+{
+    for (int row_id : chunk.satellite_row_id)
+        satellite_row_id.push_back(row_id + row_id_offset);
+
+    snapshot_id.insert(snapshot_id.end(), chunk.snapshot_id.begin(), chunk.snapshot_id.end());
+
+    // The chunk numbered its categories on its own; its codes are translated into this store's.
+    for (int column = 0; column < UCS_CATEGORY_COUNT; ++column)
+    {
+        std::vector<category_code_t> translation = categories[column].merge(chunk.categories[column]);
+
+        for (category_code_t code : chunk.category_codes[column])
+            category_codes[column].push_back(translation[code]);
+    }
+
+    aligned_vector<double> UCSSatelliteColumns::* const numeric_columns[] = {
+            &UCSSatelliteColumns::longitude, &UCSSatelliteColumns::perigee, &UCSSatelliteColumns::apogee,
+            &UCSSatelliteColumns::eccentricity, &UCSSatelliteColumns::inclination, &UCSSatelliteColumns::period,
+            &UCSSatelliteColumns::launch_mass, &UCSSatelliteColumns::kepler_x, &UCSSatelliteColumns::kepler_y,
+            &UCSSatelliteColumns::kepler_mass, &UCSSatelliteColumns::secondary_mass, &UCSSatelliteColumns::satellite_velocity
+    };
+
+    for (aligned_vector<double> UCSSatelliteColumns::* column : numeric_columns)
+        (this->*column).insert((this->*column).end(), (chunk.*column).begin(), (chunk.*column).end());
+
+    eligible.append(chunk.eligible);
+    qualifying.append(chunk.qualifying);
+    parse_reason.insert(parse_reason.end(), chunk.parse_reason.begin(), chunk.parse_reason.end());
+}
+
+/**
+ * Appends one row to every column, converting the raw UCS units to SI units on the way.
+ *
+ * @param row_id                 Row number in the UCS DB
+ * @param codes                  Dictionary codes of the categorical variables, indexed by ucs_category_t
+ * @param values                 Longitude, perigee, apogee, eccentricity, inclination, period and launch mass, as in the UCS DB
+ * @param reason                 Disqualification reason found while parsing (0 if none)
+ * @param eccentricity_qualifier Maximum eccentricity value allowed to be a qualifier satellite
+ */
+void UCSSatelliteColumns::push_row(int row_id, const category_code_t (&codes)[UCS_CATEGORY_COUNT], const double (&values)[7], int reason, double eccentricity_qualifier)
+{
+    satellite_row_id.push_back(row_id);
+    snapshot_id.push_back(0);
+
+    for (int column = 0; column < UCS_CATEGORY_COUNT; ++column)
+        category_codes[column].push_back(codes[column]);
+
+    longitude.push_back(values[0]);
+    perigee.push_back(values[1] * 1000); // CONVERSION from km to m.
+    apogee.push_back(values[2] * 1000); // CONVERSION from km to m.
+    eccentricity.push_back(values[3]);
+    inclination.push_back(values[4]);
+    period.push_back(values[5] * 60); // CONVERSION from minutes to seconds.
+    launch_mass.push_back(values[6]);
+
+    /* If our eccentricity is higher than the command-line parameter provided,
+     * disqualify this satellite. */
+    eligible.push_back(reason == 0);
+    qualifying.push_back(reason == 0 && !(values[3] > eccentricity_qualifier));
+    parse_reason.push_back(reason);
+
+    kepler_x.push_back(0);
+    kepler_y.push_back(0);
+    kepler_mass.push_back(0);
+    secondary_mass.push_back(0);
+    satellite_velocity.push_back(0);
+}
+
+/**
+ * Re-evaluates every row against a new eccentricity qualifier. Rows that were disqualified
+ * for a missing or malformed parameter (not eligible) can never qualify.
+ *
+ * @param eccentricity_qualifier New maximum eccentricity value
+ */
+void UCSSatelliteColumns::update_satellite_qualification(double eccentricity_qualifier)
+{
+    Qualification_fn::qualify(eccentricity.data(), eligible.words(), qualifying.words(), size(), eccentricity_qualifier);
+}
+
+/**
+ * Why a row is disqualified: its parse-time reason if it is not eligible, otherwise
+ * DISQ_REASON_ECCENTRICITY if it does not qualify (0 if it does).
+ */
+int UCSSatelliteColumns::disqualification_reason(size_t row) const
+{
+    if (parse_reason[row] != 0)
+        return parse_reason[row];
+
+    return qualifying.test(row) ? 0 : DISQ_REASON_ECCENTRICITY;
+}
+
+/**
+ * Runs the Kepler and secondary-method batch kernel over every row. Results do not depend on
+ * qualification, so rows that are disqualified later simply keep values nobody reads; rows
+ * with missing parameters end up holding NaN.
+ */
+void UCSSatelliteColumns::compute_statistics()
+{
+    kepler_batch_t batch = {
+            perigee.data(), apogee.data(), period.data(), kepler_x.data(), kepler_y.data(),
+            kepler_mass.data(), satellite_velocity.data(), secondary_mass.data(), size()
+    };
+
+    Kepler_fn::compute(batch);
+}
+
+/**
+ * Runs the batch kernel over the listed rows only. Their inputs are gathered into dense blocks
+ * of SELECTION_GATHER_ROWS rows, run through the kernel and scattered back, so the kernel still
+ * streams through contiguous memory. Every row gets the same bits as from compute_statistics().
+ *
+ * @param rows Selection vector of the rows to compute
+ */
+void UCSSatelliteColumns::compute_statistics(const std::vector<uint32_t>& rows)
+{
+    aligned_vector<double> block(8 * SELECTION_GATHER_ROWS);
+    double* inputs[3] = {block.data(), block.data() + SELECTION_GATHER_ROWS, block.data() + 2 * SELECTION_GATHER_ROWS};
+    double* outputs[5];
+
+    for (int i = 0; i < 5; ++i)
+        outputs[i] = block.data() + (3 + i) * SELECTION_GATHER_ROWS;
+
+    for (size_t first = 0; first < rows.size(); first += SELECTION_GATHER_ROWS)
+    {
+        size_t count = std::min(SELECTION_GATHER_ROWS, rows.size() - first);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t row = rows[first + i];
+            inputs[0][i] = perigee[row];
+            inputs[1][i] = apogee[row];
+            inputs[2][i] = period[row];
+        }
+
+        kepler_batch_t batch = {
+                inputs[0], inputs[1], inputs[2], outputs[0], outputs[1],
+                outputs[2], outputs[3], outputs[4], count
+        };
+
+        Kepler_fn::compute(batch);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t row = rows[first + i];
+            kepler_x[row] = outputs[0][i];
+            kepler_y[row] = outputs[1][i];
+            kepler_mass[row] = outputs[2][i];
+            satellite_velocity[row] = outputs[3][i];
+            secondary_mass[row] = outputs[4][i];
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSSATELLITECOLUMNS_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSSATELLITECOLUMNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+#include "candidate_satellite_t.h"
+#include "candidate_satellite_view_t.h"
+#include "UCSBitmask.h"
+#include "UCSCategoryDictionary.h"
+#include "UCSFieldParser.h"
+#include "ucs_column_set_t.h"
+
+typedef double kepler_relation_coord_t;
+typedef double mass_t;
+typedef double velocity_t;
+
+/**
+ * Minimal allocator that hands out Alignment-byte aligned storage, so every column starts
+ * on a cache line and can be read with aligned vector loads.
+ */
+template<typename T, size_t Alignment = 64>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+template<typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * Structure-of-arrays storage for the whole UCS satellite database. Row i of every column
+ * describes the same satellite, so an analysis loop only pulls the columns it actually reads
+ * through the cache. Numeric fields that are missing or unparsable are stored as NaN and the
+ * row is permanently disqualified. Text fields are dictionary-encoded, one dictionary per column.
+ */
+class UCSSatelliteColumns
+{
+public:
+    std::vector<int> satellite_row_id; /*!< Row number in the UCS DB */
+    std::vector<int> snapshot_id; /*!< Which loaded UCS DB (snapshot) the row comes from */
+    std::vector<category_code_t> category_codes[UCS_CATEGORY_COUNT]; /*!< Categorical variables from UCS DB, as codes into categories (indexed by ucs_category_t) */
+    UCSCategoryDictionary categories[UCS_CATEGORY_COUNT]; /*!< Values of the categorical variables */
+    aligned_vector<double> longitude, perigee, apogee, eccentricity, inclination, period, launch_mass; /*!< Variable(s) from UCS DB (SI units) */
+    UCSBitmask eligible; /*!< Whether each satellite has every parameter present and well-formed, i.e. can ever qualify */
+    UCSBitmask qualifying; /*!< Whether each satellite qualifies for calculations under the current eccentricity qualifier */
+    std::vector<int> parse_reason; /*!< Why each satellite is not eligible (0 if it is) */
+    aligned_vector<kepler_relation_coord_t> kepler_x; /*!< Computed Kepler x-coordinates */
+    aligned_vector<kepler_relation_coord_t> kepler_y; /*!< Computed Kepler y-coordinates */
+    aligned_vector<mass_t> kepler_mass; /*!< Earth-mass estimations from Kepler's 3rd law */
+    aligned_vector<mass_t> secondary_mass; /*!< Earth-mass estimations (secondary method) */
+    aligned_vector<velocity_t> satellite_velocity; /*!< Orbital velocity estimations from the period (ms-1) */
+    ucs_column_set_t materialized = UCS_COLUMNS_ALL; /*!< Input columns that hold values; append() only converts these */
+
+    inline size_t size() const { return satellite_row_id.size(); };
+    int disqualification_reason(size_t row) const;
+    inline const std::string& category(ucs_category_t column, size_t row) const { return categories[column].value(category_codes[column][row]); };
+    void reserve(size_t rows);
+    void clear();
+
+    void append(const candidate_satellite_t& sat, UCSFieldParser& parser);
+    void append(const candidate_satellite_view_t& sat, UCSFieldParser& parser);
+    void append_chunk(UCSSatelliteColumns& chunk, int row_id_offset);
+    void copy_columns(const UCSSatelliteColumns& source, size_t first_row, ucs_column_set_t columns);
+
+    void update_satellite_qualification(double eccentricity_qualifier);
+
+    void compute_statistics();
+    void compute_statistics(const std::vector<uint32_t>& rows);
+private:
+    void push_row(int row_id, const category_code_t (&codes)[UCS_CATEGORY_COUNT], const double (&values)[7], int reason, double eccentricity_qualifier);
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSSATELLITECOLUMNS_H
@@ -5,89 +5,493 @@
 #include "UCSSatelliteDatabase.h"
 #include "include/csv.h"
 #include "include/loguru.hpp"
+#include "UCSMappedFile.h"
+#include "UCSRowTokenizer.h"
+#include "UCSSanitizer.h"
+#include "UCSColumnCache.h"
+#include "UCSDecompressingByteSource.h"
+#include "ThreadPool.h"
+#include "FusedAnalysisEngine.h"
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 using string = std::string;
 
+namespace
+{
+    /**
+     * The snapshot labels of the output csv files: the input paths, double-quoted (with embedded
+     * quotes doubled) when they hold a character that would otherwise end or split the field.
+     */
+    std::vector<string> csv_labels(const std::vector<string>& paths)
+    {
+        std::vector<string> labels;
+
+        for (const string& path : paths)
+        {
+            if (path.find_first_of(",\"\r\n") == string::npos)
+            {
+                labels.push_back(path);
+                continue;
+            }
+
+            string label = "\"";
+
+            for (char c : path)
+                label += (c == '"') ? string("\"\"") : string(1, c);
+
+            labels.push_back(label + "\"");
+        }
+
+        return labels;
+    }
+}
+
 /**
- * Parses the UCS CSV file given at csv_path and populates the m_satellites vector with
- * UCSSatelliteEntry entities that represent each satellite in the database.
+ * Parses the UCS CSV file given at csv_path and populates the m_columns store with
+ * one row for each satellite in the database.
  *
  * @param csv_path               Path of UCS CSV file to parse
  * @param eccentricity_qualifier Maximum eccentricity value allowed to be a qualifier satellite
+ * If options.cache_path names an up-to-date snapshot of csv_path, the columns are loaded from it
+ * instead; otherwise the text file is parsed and a fresh snapshot is written there.
+ *
+ * @param options                Selects the ingest path (csv.h or memory-mapped), the sanitizer stage and the snapshot file
  */
-UCSSatelliteDatabase::UCSSatelliteDatabase(const string &csv_path, double eccentricity_qualifier)
+UCSSatelliteDatabase::UCSSatelliteDatabase(const string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options)
+    : UCSSatelliteDatabase(std::vector<string> {csv_path}, eccentricity_qualifier, options)
+{
+}
+
+/**
+ * Parses several UCS CSV files (snapshots of the database) into one column store. Snapshot i
+ * holds the rows of csv_paths[i], in file order, and keeps the row ids of that file.
+ *
+ * With more than one input, the files are parsed concurrently on options.pool, each on a single
+ * worker. Their reports are held back and printed in input order, and every input gets its own
+ * column snapshot, at options.cache_path followed by "." and its snapshot id.
+ *
+ * @param csv_paths              Paths of the UCS CSV files to parse
+ * @param eccentricity_qualifier Maximum eccentricity value allowed to be a qualifier satellite
+ * @param options                Selects the ingest path, the sanitizer stage, the snapshot file(s) and the workers
+ */
+UCSSatelliteDatabase::UCSSatelliteDatabase(const std::vector<string> &csv_paths, double eccentricity_qualifier, const ucs_ingest_options_t &options)
+    : m_snapshot_paths(csv_paths), m_snapshot_labels(csv_labels(csv_paths)), m_ingest_options(options), m_eccentricity_qualifier(eccentricity_qualifier)
 {
     try {
-        io::CSVReader<8, io::trim_chars<' '>, io::no_quote_escape<'\t'>, io::throw_on_overflow, io::single_line_comment<'#'>> in(
-                csv_path);
-        in.read_header(io::ignore_extra_column,
-                       "Class of Orbit", "Longitude of GEO (degrees)", "Perigee (km)", "Apogee (km)", "Eccentricity",
-                       "Inclination (degrees)", "Period (minutes)", "Launch Mass (kg.)");
-        int count = 0;
-        int disqualified_satellites = 0;
+        if (csv_paths.size() == 1)
+        {
+            parsed_snapshot_t snapshot;
+            load_snapshot(csv_paths[0], eccentricity_qualifier, options, std::cout, snapshot);
+
+            m_snapshot_rows.push_back(snapshot.columns.size());
+            m_columns = std::move(snapshot.columns);
+            m_field_parser = std::move(snapshot.field_parser);
+            m_loaded_from_cache = snapshot.loaded_from_cache;
+            return;
+        }
 
-        string pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination, pre_period, pre_launch_mass;
+        std::vector<parsed_snapshot_t> snapshots(csv_paths.size());
+        std::vector<std::ostringstream> logs(csv_paths.size());
 
-        auto start = std::chrono::high_resolution_clock::now();
+        // The workers are busy with whole files, so every file is parsed in one piece.
+        ucs_ingest_options_t snapshot_options = options;
+        snapshot_options.chunked = false;
 
-        while (in.read_row(pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination,
-                           pre_period, pre_launch_mass)) {
-            count++;
+        auto load = [&](size_t snapshot_id, unsigned) {
+            ucs_ingest_options_t own_options = snapshot_options;
 
-            candidate_satellite_t candidate_satellite = {
-                    count, pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination,
-                    pre_period, pre_launch_mass, eccentricity_qualifier
-            };
+            if (!options.cache_path.empty())
+                own_options.cache_path = options.cache_path + "." + std::to_string(snapshot_id);
 
-            // Create a UCSSatelliteEntry object to match this raw CSV entry
-            UCSSatelliteEntry entry(candidate_satellite);
+            load_snapshot(csv_paths[snapshot_id], eccentricity_qualifier, own_options, logs[snapshot_id], snapshots[snapshot_id]);
+        };
 
-            if (!entry.isQualified())
-                disqualified_satellites++;
+        if (options.pool)
+            options.pool->parallel_for(csv_paths.size(), load);
+        else
+            for (size_t snapshot_id = 0; snapshot_id < csv_paths.size(); ++snapshot_id)
+                load(snapshot_id, 0);
 
-            // Push this to guy the satellite vector
-            m_satellites.push_back(entry);
-        }
+        size_t total_rows = 0;
+
+        for (const parsed_snapshot_t& snapshot : snapshots)
+            total_rows += snapshot.columns.size();
+
+        m_columns.reserve(total_rows);
+        m_loaded_from_cache = true;
 
-        auto stop = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+        for (size_t snapshot_id = 0; snapshot_id < snapshots.size(); ++snapshot_id)
+        {
+            parsed_snapshot_t& snapshot = snapshots[snapshot_id];
+            string log = logs[snapshot_id].str();
 
-        m_csv_path = csv_path;
+            if (!log.empty())
+                std::cout << "In " << csv_paths[snapshot_id] << ":" << std::endl << log;
+
+            m_snapshot_rows.push_back(snapshot.columns.size());
+            m_columns.materialized &= snapshot.columns.materialized;
+            std::fill(snapshot.columns.snapshot_id.begin(), snapshot.columns.snapshot_id.end(), static_cast<int>(snapshot_id));
+            m_columns.append_chunk(snapshot.columns, 0);
+            m_field_parser.merge(snapshot.field_parser, 0);
+            m_loaded_from_cache = m_loaded_from_cache && snapshot.loaded_from_cache;
+        }
 
     } catch (const io::error::too_few_columns& e) {
-        std::cout << "Parse failed! You may need to use the preprocess.py script to sanitize the database file first." << std::endl;
+        std::cout << "Parse failed! You may need to sanitize the database file first (pass --sanitize, or use the preprocess.py script)." << std::endl;
+        exit(-1);
+    } catch (const io::error::too_many_columns& e) {
+        std::cout << "Parse failed! You may need to sanitize the database file first (pass --sanitize, or use the preprocess.py script)." << std::endl;
+        exit(-1);
+    } catch (const io::error::base& e) {
+        std::cout << "Parse failed! " << e.what() << std::endl;
+        exit(-1);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Parse failed! " << e.what() << std::endl;
         exit(-1);
     }
 }
 
+/**
+ * Loads one input file, from its column snapshot if options.cache_path names an up-to-date one,
+ * and otherwise by parsing the text file and writing a fresh snapshot there. Without a snapshot,
+ * only options.columns are converted.
+ *
+ * @param log Where the field diagnostics and the sanitizer report are written
+ */
+void UCSSatelliteDatabase::load_snapshot(const string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options,
+                                         std::ostream &log, parsed_snapshot_t &snapshot)
+{
+    // Column snapshots always hold every column, so they are written from fully parsed stores.
+    snapshot.columns.materialized = options.cache_path.empty() ? options.columns : UCS_COLUMNS_ALL;
+
+    if (!options.cache_path.empty() && UCSColumnCache::load(options.cache_path, csv_path, options, eccentricity_qualifier, snapshot.columns))
+    {
+        snapshot.loaded_from_cache = true;
+        return;
+    }
+
+    if (options.memory_mapped || options.sanitize || options.chunked)
+        load_mapped_csv(csv_path, eccentricity_qualifier, options, log, snapshot);
+    else
+        load_csv(csv_path, eccentricity_qualifier, snapshot);
+
+    snapshot.field_parser.report(log, MAX_REPORTED_FIELD_ERRORS);
+
+    if (!options.cache_path.empty() && !UCSColumnCache::write(options.cache_path, csv_path, options, snapshot.columns))
+        log << "Could not write the column snapshot " << options.cache_path << std::endl;
+}
+
+/**
+ * Reads csv_path row by row through io::CSVReader.
+ */
+void UCSSatelliteDatabase::load_csv(const string &csv_path, double eccentricity_qualifier, parsed_snapshot_t &snapshot)
+{
+    typedef io::CSVReader<12, io::trim_chars<' '>, io::no_quote_escape<'\t'>, io::throw_on_overflow, io::single_line_comment<'#'>> ucs_csv_reader_t;
+
+    // Compressed files are decompressed by the byte source, on csv.h's reader thread.
+    compression_t compression = UCSDecompressingByteSource::detect_compression(csv_path);
+    std::unique_ptr<ucs_csv_reader_t> reader = (compression == compression_t::none)
+            ? std::make_unique<ucs_csv_reader_t>(csv_path)
+            : std::make_unique<ucs_csv_reader_t>(csv_path, std::make_unique<UCSDecompressingByteSource>(csv_path, compression));
+    ucs_csv_reader_t& in = *reader;
+
+    // The four categorical columns after the launch mass are optional, so only the others are checked for.
+    in.read_header(io::ignore_extra_column | io::ignore_missing_column,
+                   "Class of Orbit", "Longitude of GEO (degrees)", "Perigee (km)", "Apogee (km)", "Eccentricity",
+                   "Inclination (degrees)", "Period (minutes)", "Launch Mass (kg.)",
+                   "Country of Operator/Owner", "Operator/Owner", "Users", "Purpose");
+
+    for (const char* required : {"Class of Orbit", "Longitude of GEO (degrees)", "Perigee (km)", "Apogee (km)", "Eccentricity",
+                                 "Inclination (degrees)", "Period (minutes)", "Launch Mass (kg.)"})
+    {
+        if (!in.has_column(required))
+        {
+            io::error::missing_column_in_header err;
+            err.set_column_name(required);
+            err.set_file_name(in.get_truncated_file_name());
+            throw err;
+        }
+    }
+
+    int count = 0;
+    int disqualified_satellites = 0;
+
+    string pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination, pre_period, pre_launch_mass;
+    string pre_country, pre_operator, pre_users, pre_purpose;
+
+    while (in.read_row(pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination,
+                       pre_period, pre_launch_mass, pre_country, pre_operator, pre_users, pre_purpose)) {
+        count++;
+
+        candidate_satellite_t candidate_satellite = {
+                count, pre_orbit, pre_longitude, pre_perigee, pre_apogee, pre_eccentricity, pre_inclination,
+                pre_period, pre_launch_mass, pre_country, pre_operator, pre_users, pre_purpose, eccentricity_qualifier
+        };
+
+        // Validate this raw CSV entry and push it to the column store
+        snapshot.columns.append(candidate_satellite, snapshot.field_parser);
+
+        if (!snapshot.columns.qualifying.back())
+            disqualified_satellites++;
+    }
+}
+
+/**
+ * Tokenizes every remaining row of tokenizer, optionally through a sanitizer, and appends it to
+ * columns. Row ids count up from 1 within whatever the tokenizer covers.
+ */
+void UCSSatelliteDatabase::parse_rows(UCSRowTokenizer &tokenizer, UCSSanitizer *sanitizer, double eccentricity_qualifier,
+                                      UCSSatelliteColumns &columns, UCSFieldParser &parser)
+{
+    candidate_satellite_view_t candidate_satellite {};
+    candidate_satellite.eccentricity_qualifier = eccentricity_qualifier;
+
+    std::string_view line;
+
+    while (tokenizer.next_data_line(line))
+    {
+        if (sanitizer && !sanitizer->check_delimiters(line, tokenizer.get_file_line()))
+            continue;
+
+        tokenizer.split_row(line, candidate_satellite);
+
+        if (sanitizer && !sanitizer->rewrite_eccentricity(line, candidate_satellite, tokenizer.get_file_line()))
+            continue;
+
+        candidate_satellite.p_satellite_row_id = static_cast<int>(columns.size()) + 1;
+        columns.append(candidate_satellite, parser);
+    }
+}
+
+/**
+ * Splits the rest of the file at line boundaries and parses the chunks concurrently, each into
+ * its own column store, field parser and (if sanitizing) chunk sanitizer. The chunks are then
+ * stitched together in file order, so rows, row ids, diagnostics and the sanitizer report come
+ * out exactly as a single-threaded pass would produce them.
+ *
+ * @param tokenizer Tokenizer that has read the header
+ * @param sanitizer Sanitizer for the whole file, or nullptr
+ * @param pool      Workers to parse on
+ * @param snapshot  Receives the stitched rows and diagnostics
+ */
+void UCSSatelliteDatabase::parse_chunks(UCSRowTokenizer &tokenizer, UCSSanitizer *sanitizer, double eccentricity_qualifier, ThreadPool &pool,
+                                        parsed_snapshot_t &snapshot)
+{
+    struct parsed_chunk_t {
+        UCSSatelliteColumns columns;
+        UCSFieldParser parser;
+        std::unique_ptr<UCSSanitizer> sanitizer;
+    };
+
+    std::vector<std::string_view> chunks = tokenizer.split_remaining(pool.size() * CHUNKS_PER_PARSE_WORKER);
+    std::vector<unsigned> lines_before(chunks.size(), 0);
+
+    // Line numbers are only needed for error messages, but they have to be absolute.
+    pool.parallel_for(chunks.size(), [&](size_t chunk, unsigned) {
+        lines_before[chunk] = static_cast<unsigned>(std::count(chunks[chunk].begin(), chunks[chunk].end(), '\n'));
+    });
+
+    unsigned line = tokenizer.get_file_line();
+
+    for (unsigned& chunk_lines : lines_before)
+    {
+        unsigned lines = chunk_lines;
+        chunk_lines = line;
+        line += lines;
+    }
+
+    std::vector<parsed_chunk_t> parsed(chunks.size());
+
+    pool.parallel_for(chunks.size(), [&](size_t chunk, unsigned) {
+        UCSRowTokenizer chunk_tokenizer(tokenizer, chunks[chunk], lines_before[chunk]);
+
+        if (sanitizer)
+            parsed[chunk].sanitizer = sanitizer->make_chunk_sanitizer();
+
+        parsed[chunk].columns.materialized = snapshot.columns.materialized;
+
+        parse_rows(chunk_tokenizer, parsed[chunk].sanitizer.get(), eccentricity_qualifier, parsed[chunk].columns, parsed[chunk].parser);
+    });
+
+    size_t total_rows = 0;
+
+    for (const parsed_chunk_t& chunk : parsed)
+        total_rows += chunk.columns.size();
+
+    snapshot.columns.reserve(total_rows);
+
+    for (parsed_chunk_t& chunk : parsed)
+    {
+        int row_id_offset = static_cast<int>(snapshot.columns.size());
+
+        snapshot.field_parser.merge(chunk.parser, row_id_offset);
+        snapshot.columns.append_chunk(chunk.columns, row_id_offset);
+
+        if (sanitizer)
+            sanitizer->merge(*chunk.sanitizer);
+    }
+}
+
+/**
+ * Maps csv_path into memory and tokenizes it in place. Every field reaches the numeric
+ * parser as a std::string_view into the mapping, so no per-field strings are allocated.
+ *
+ * With options.sanitize set, every raw line goes through a UCSSanitizer on its way to the
+ * tokenizer, so unsanitized UCS downloads can be read directly in the same single pass.
+ *
+ * With options.chunked set, the rows are parsed in chunks across the workers of options.pool
+ * (see parse_chunks()).
+ */
+void UCSSatelliteDatabase::load_mapped_csv(const string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options,
+                                           std::ostream &log, parsed_snapshot_t &snapshot)
+{
+    // A compressed file cannot be mapped; it is decompressed into memory up front instead.
+    compression_t compression = UCSDecompressingByteSource::detect_compression(csv_path);
+    std::unique_ptr<UCSMappedFile> mapped_file;
+    string decompressed;
+    std::string_view data;
+
+    if (compression == compression_t::none)
+    {
+        mapped_file = std::make_unique<UCSMappedFile>(csv_path);
+        data = mapped_file->view();
+    } else {
+        decompressed = UCSDecompressingByteSource::read_all(csv_path, compression);
+        data = decompressed;
+    }
+
+    UCSRowTokenizer tokenizer(data, csv_path);
+    tokenizer.read_header();
+
+    std::unique_ptr<UCSSanitizer> sanitizer;
+
+    if (options.sanitize)
+        sanitizer = std::make_unique<UCSSanitizer>(tokenizer.get_header_line(), options.sanitized_output_path, log);
+
+    if (options.chunked && options.pool && options.pool->size() > 1)
+    {
+        parse_chunks(tokenizer, sanitizer.get(), eccentricity_qualifier, *options.pool, snapshot);
+    } else {
+        parse_rows(tokenizer, sanitizer.get(), eccentricity_qualifier, snapshot.columns, snapshot.field_parser);
+    }
+
+    if (sanitizer)
+        sanitizer->report();
+}
+
 UCSSatelliteDatabase::~UCSSatelliteDatabase() = default;
 
 /**
- * Calls UCSSatelliteEntry::compute_kepler_statistics() on each element of the
- * member satellite vector.
+ * Makes sure the given input columns hold values. Columns that were skipped while loading are
+ * filled in by parsing every snapshot again with only the missing columns converted; the
+ * diagnostics and sanitizer report of that pass are discarded, as they were printed on load.
+ *
+ * @param columns Input columns that the caller is about to read
+ */
+void UCSSatelliteDatabase::materialize_columns(ucs_column_set_t columns)
+{
+    ucs_column_set_t missing = columns & ~m_columns.materialized;
+
+    if (!missing)
+        return;
+
+    ucs_ingest_options_t options = m_ingest_options;
+    options.columns = missing;
+    options.sanitized_output_path.clear();
+    options.cache_path.clear();
+
+    size_t first_row = 0;
+
+    try {
+        for (size_t snapshot_id = 0; snapshot_id < m_snapshot_paths.size(); ++snapshot_id)
+        {
+            parsed_snapshot_t snapshot;
+            std::ostringstream discarded;
+            load_snapshot(m_snapshot_paths[snapshot_id], m_eccentricity_qualifier, options, discarded, snapshot);
+
+            if (snapshot.columns.size() != m_snapshot_rows[snapshot_id])
+                throw std::runtime_error(m_snapshot_paths[snapshot_id] + " changed on disk since it was loaded");
+
+            m_columns.copy_columns(snapshot.columns, first_row, missing);
+            first_row += m_snapshot_rows[snapshot_id];
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Could not read the remaining columns! " << e.what() << std::endl;
+        exit(-1);
+    }
+
+    m_columns.materialized |= missing;
+}
+
+/**
+ * Fills the Kepler result columns (kepler_x, kepler_y, kepler_mass) of the qualifying rows.
+ * The batch kernel computes them together with the secondary method; since none of the results
+ * depend on the eccentricity qualifier, a row is only ever computed once.
  */
 void UCSSatelliteDatabase::compute_kepler_statistics()
 {
-    /* Iterate through the satellite vector. Call each satellite's member
-     * compute_kepler_statistics function. */
+    ensure_statistics(get_selection());
+}
+
+/**
+ * Fills the result columns of every row that can qualify under some eccentricity qualifier,
+ * which is what an MEQ sweep reads.
+ */
+void UCSSatelliteDatabase::compute_sweep_statistics()
+{
+    std::vector<uint32_t> eligible_rows;
+    m_columns.eligible.select(eligible_rows);
+    ensure_statistics(eligible_rows);
+}
+
+/**
+ * Runs the batch kernel over those of rows that have not been computed yet. When that is every
+ * row, the kernel runs straight over the columns instead of gathering them.
+ */
+void UCSSatelliteDatabase::ensure_statistics(const std::vector<uint32_t> &rows)
+{
+    if (m_statistics_rows.size() != m_columns.size())
+        m_statistics_rows.assign(m_columns.size(), false);
 
-    int computedSatellites = 0;
+    std::vector<uint32_t> missing;
 
-    for (UCSSatelliteEntry &entry : m_satellites)
+    for (uint32_t row : rows)
     {
-        computedSatellites++;
+        if (!m_statistics_rows.test(row))
+            missing.push_back(row);
+    }
 
-        // If the satellite does not qualify, then don't bother computing statistics
-        if (!entry.isQualified())
-            continue;
+    if (missing.empty())
+        return;
+
+    if (missing.size() == m_columns.size())
+        m_columns.compute_statistics();
+    else
+        m_columns.compute_statistics(missing);
+
+    for (uint32_t row : missing)
+        m_statistics_rows.set(row, true);
+}
 
-        entry.compute_kepler_statistics();
-        // std::cout << "\rComputing extended statistics [" << computedSatellites << "]";
+/**
+ * Returns the selection vector of the qualifying rows. It is built from the qualification
+ * bitmask once per qualification change; every per-row stage iterates it instead of testing
+ * each satellite.
+ */
+const std::vector<uint32_t>& UCSSatelliteDatabase::get_selection()
+{
+    if (!m_selection_valid)
+    {
+        m_columns.qualifying.select(m_selection);
+        m_selection_valid = true;
     }
 
-    // std::cout << "\rComputing extended statistics [done]" << std::endl;
+    return m_selection;
 }
 
 /**
@@ -99,30 +503,126 @@ void UCSSatelliteDatabase::dump_kepler_data_to_csv(string& path)
 {
     std::ofstream basicOfstream;
     basicOfstream.open(path);
-    basicOfstream << "x,y,mass_estimation_kepler,mass_estimation_secondary" << std::endl;
+    // With several snapshots loaded, every row says which one it comes from.
+    bool with_snapshot = m_snapshot_paths.size() > 1;
 
-    for (UCSSatelliteEntry &entry : m_satellites)
+    basicOfstream << (with_snapshot ? "snapshot," : "") << "x,y,mass_estimation_kepler,mass_estimation_secondary" << std::endl;
+
+    // Disqualified entries are not in the selection.
+    for (uint32_t row : get_selection())
     {
-        // If this entry is disqualified, ignore it.
-        if (!entry.isQualified())
-            continue;
+        if (with_snapshot)
+            basicOfstream << m_snapshot_labels[m_columns.snapshot_id[row]] << ",";
+
+        basicOfstream << m_columns.kepler_x[row] << "," << m_columns.kepler_y[row] << "," << m_columns.kepler_mass[row] << "," << m_columns.secondary_mass[row] << std::endl;
+    }
+
+    basicOfstream.close();
+}
+
+/**
+ * Fused non-MEQ analysis: computes both mass estimates of every qualifying satellite, folds them
+ * into the moments, quantile sketches and Kepler regression of both methods and writes the same
+ * csv as dump_kepler_data_to_csv, all in one pass over the selection instead of one pass per stage.
+ *
+ * The selection is cut into shards of at most ANALYSIS_SHARD_ROWS rows that never straddle two
+ * snapshots. Each shard is analyzed by its own FusedAnalysisEngine into its own text buffer, a
+ * pool's worth of shards at a time; the buffers are then written and the engines merged in shard
+ * order. Shards depend on the data alone, so the results are the same for any pool size. Since no
+ * shard spans two snapshots, the shard engines can also be merged per snapshot.
+ *
+ * @param path                 Where to write the csv
+ * @param pool                 Workers to analyze shards on (nullptr to analyze them on the calling thread)
+ * @param percentiles          If not nullptr, receives the REPORTED_QUANTILES of both mass estimations
+ * @param snapshot_percentiles If not nullptr, receives the same for each snapshot on its own, in snapshot id order
+ * @return The statistics of every qualifying satellite; the medians, like the percentiles, come
+ *         from quantile sketches and are approximate past QUANTILE_SKETCH_K rows
+ */
+ecm_analysis_t UCSSatelliteDatabase::analyze_to_csv(string& path, ThreadPool* pool, mass_percentiles_t* percentiles,
+                                                    std::vector<mass_percentiles_t>* snapshot_percentiles)
+{
+    std::ofstream basicOfstream;
+    basicOfstream.open(path);
+    bool with_snapshot = m_snapshot_paths.size() > 1;
+
+    basicOfstream << (with_snapshot ? "snapshot," : "") << "x,y,mass_estimation_kepler,mass_estimation_secondary" << std::endl;
+
+    const std::vector<uint32_t>& rows = get_selection();
+    std::vector<size_t> shard_begin {0};
+
+    for (size_t i = 1; i < rows.size(); ++i)
+    {
+        if (i - shard_begin.back() == ANALYSIS_SHARD_ROWS || m_columns.snapshot_id[rows[i]] != m_columns.snapshot_id[rows[i - 1]])
+            shard_begin.push_back(i);
+    }
+
+    shard_begin.push_back(rows.size());
+
+    size_t shard_count = shard_begin.size() - 1;
+    size_t wave_size = pool ? pool->size() : 1;
+    FusedAnalysisEngine engine;
+    std::vector<FusedAnalysisEngine> shard_engines(std::min(wave_size, shard_count));
+    std::vector<std::ostringstream> shard_outputs(shard_engines.size());
+    std::vector<FusedAnalysisEngine> snapshot_engines(snapshot_percentiles ? m_snapshot_paths.size() : 0);
 
-        basicOfstream << entry.getKeplerX() << "," << entry.getKeplerY() << "," << entry.getKeplerMass() << "," << entry.getSecondaryMass() << std::endl;
+    for (size_t wave = 0; wave < shard_count; wave += wave_size)
+    {
+        size_t wave_shards = std::min(wave_size, shard_count - wave);
+
+        auto analyze_shard = [&](size_t i, unsigned) {
+            size_t shard = wave + i;
+            shard_engines[i].clear();
+            shard_outputs[i].str("");
+            shard_engines[i].add(m_columns, rows.data() + shard_begin[shard], shard_begin[shard + 1] - shard_begin[shard],
+                                 &shard_outputs[i], with_snapshot ? &m_snapshot_labels : nullptr);
+        };
+
+        if (pool)
+            pool->parallel_for(wave_shards, analyze_shard);
+        else
+            analyze_shard(0, 0);
+
+        for (size_t i = 0; i < wave_shards; ++i)
+        {
+            basicOfstream << shard_outputs[i].str();
+            engine.merge(shard_engines[i]);
+
+            if (snapshot_percentiles && shard_begin[wave + i] < rows.size())
+                snapshot_engines[m_columns.snapshot_id[rows[shard_begin[wave + i]]]].merge(shard_engines[i]);
+        }
     }
 
     basicOfstream.close();
+
+    if (m_statistics_rows.size() != m_columns.size())
+        m_statistics_rows.assign(m_columns.size(), false);
+
+    for (uint32_t row : rows)
+        m_statistics_rows.set(row, true);
+
+    if (percentiles)
+        engine.percentiles(*percentiles);
+
+    if (snapshot_percentiles)
+    {
+        snapshot_percentiles->resize(snapshot_engines.size());
+
+        for (size_t snapshot = 0; snapshot < snapshot_engines.size(); ++snapshot)
+            snapshot_engines[snapshot].percentiles((*snapshot_percentiles)[snapshot]);
+    }
+
+    return engine.result(m_eccentricity_qualifier, get_satellite_count());
 }
 
 /**
- * Dynamically updates the qualification status for each satellite in the member satellite
- * vector. This is usually used to refresh qualifier satellites after the eccentricity qualifier
+ * Dynamically updates the qualification status for each satellite in the column store.
+ * This is usually used to refresh qualifier satellites after the eccentricity qualifier
  * changes.
  */
 void UCSSatelliteDatabase::update_satellite_qualification()
 {
-    for (UCSSatelliteEntry &satellite : m_satellites) {
-        satellite.update_satellite_qualification(m_eccentricity_qualifier);
-    }
+    m_columns.update_satellite_qualification(m_eccentricity_qualifier);
+    m_selection_valid = false;
 }
 
 /**
@@ -131,13 +631,7 @@ void UCSSatelliteDatabase::update_satellite_qualification()
  */
 std::vector<mass_t> UCSSatelliteDatabase::get_mass_estimations() {
     std::vector<mass_t> vec;
-
-    for (UCSSatelliteEntry &satellite : m_satellites) {
-        if (!satellite.isQualified())
-            continue;
-
-        vec.push_back(satellite.getKeplerMass());
-    }
+    get_mass_estimations(vec);
 
     return vec;
 }
@@ -145,37 +639,95 @@ std::vector<mass_t> UCSSatelliteDatabase::get_mass_estimations() {
 std::vector<mass_t> UCSSatelliteDatabase::get_secondary_mass_estimations()
 {
     std::vector<mass_t> vec;
+    get_secondary_mass_estimations(vec);
 
-    for (UCSSatelliteEntry &satellite : m_satellites)
-    {
-        if (!satellite.isQualified())
-            continue;
+    return vec;
+}
 
-        vec.push_back(satellite.getSecondaryMass());
-    }
+/**
+ * Replaces the contents of buffer with the Kepler mass estimations of the qualifying
+ * satellites. Reusing one buffer across calls (e.g. across MEQ steps) avoids allocating once it
+ * has grown to the largest selection.
+ */
+void UCSSatelliteDatabase::get_mass_estimations(std::vector<mass_t>& buffer)
+{
+    view_mass_estimations().copy_to(buffer);
+}
 
-    return vec;
+/**
+ * Same as get_mass_estimations(std::vector<mass_t>&), for the secondary method.
+ */
+void UCSSatelliteDatabase::get_secondary_mass_estimations(std::vector<mass_t>& buffer)
+{
+    view_secondary_mass_estimations().copy_to(buffer);
 }
 
-int UCSSatelliteDatabase::get_disqualified_satellite_count() const {
-    int buf = 0;
+/**
+ * Returns the Kepler mass estimations of the qualifying satellites without copying them. The
+ * view is invalidated by the next update_satellite_qualification().
+ */
+UCSColumnView UCSSatelliteDatabase::view_mass_estimations()
+{
+    return {m_columns.kepler_mass.data(), get_selection()};
+}
 
-    for (const UCSSatelliteEntry& entry : m_satellites)
-    {
-        if (!entry.isQualified())
-            ++buf;
-    }
+/**
+ * Same as view_mass_estimations(), for the secondary method.
+ */
+UCSColumnView UCSSatelliteDatabase::view_secondary_mass_estimations()
+{
+    return {m_columns.secondary_mass.data(), get_selection()};
+}
+
+/**
+ * Same as view_mass_estimations(), for the Kepler x coordinates (filled by the analysis, like the masses).
+ */
+UCSColumnView UCSSatelliteDatabase::view_kepler_x()
+{
+    return {m_columns.kepler_x.data(), get_selection()};
+}
 
-    return buf;
+/**
+ * Same as view_kepler_x(), for the Kepler y coordinates.
+ */
+UCSColumnView UCSSatelliteDatabase::view_kepler_y()
+{
+    return {m_columns.kepler_y.data(), get_selection()};
 }
 
-void UCSSatelliteDatabase::compute_secondary_method()
+/**
+ * Same as view_mass_estimations(), for the input perigees (SI units, as in UCSSatelliteColumns).
+ */
+UCSColumnView UCSSatelliteDatabase::view_perigees()
 {
-    for (UCSSatelliteEntry &satellite : m_satellites) {
-        if (!satellite.isQualified())
-            continue;
+    return {m_columns.perigee.data(), get_selection()};
+}
 
-        satellite.estimate_orbital_velocity();
-        satellite.estimate_earth_mass_method_2();
-    }
-}
\ No newline at end of file
+/**
+ * Same as view_perigees(), for the apogees.
+ */
+UCSColumnView UCSSatelliteDatabase::view_apogees()
+{
+    return {m_columns.apogee.data(), get_selection()};
+}
+
+/**
+ * Same as view_perigees(), for the periods.
+ */
+UCSColumnView UCSSatelliteDatabase::view_periods()
+{
+    return {m_columns.period.data(), get_selection()};
+}
+
+int UCSSatelliteDatabase::get_disqualified_satellite_count() const {
+    return static_cast<int>(m_columns.size() - m_columns.qualifying.count());
+}
+
+/**
+ * Fills the secondary-method result columns (satellite_velocity, secondary_mass) of the
+ * qualifying rows. See compute_kepler_statistics(); both share one batch kernel run.
+ */
+void UCSSatelliteDatabase::compute_secondary_method()
+{
+    ensure_statistics(get_selection());
+}
@@ -7,33 +7,96 @@
 
 #include <iostream>
 #include "UCSSatelliteEntry.h"
+#include "UCSColumnView.h"
+#include "ucs_ingest_options_t.h"
+#include "UCSFieldParser.h"
+#include "ecm_analysis_t.h"
+#include "FusedAnalysisEngine.h"
 #include <vector>
 
+class UCSRowTokenizer;
+class UCSSanitizer;
+
 /**
  * This class is a logical representation of the entirety of the UCS satellite database.
  * Its constructor automatically loads an original -- UNTOUCHED -- UCS csv file and parses it.
+ *
+ * Several releases (snapshots) of the database can be loaded into one instance. They are parsed
+ * concurrently and stored one after the other in the same column store, whose snapshot_id column
+ * tells them apart, so the statistics and MEQ sweeps run once over all of them.
  */
 class UCSSatelliteDatabase
 {
 private:
-    std::string m_csv_path; /*!< String that holds the path for the UCS database csv file */
-    std::vector<UCSSatelliteEntry> m_satellites; /*!< Vector of UCSSatelliteEntry objects that make up this database */
+    /**
+     * Everything parsed from one input file, before it is added to the database.
+     */
+    struct parsed_snapshot_t {
+        UCSSatelliteColumns columns;
+        UCSFieldParser field_parser;
+        bool loaded_from_cache = false;
+    };
+
+    std::vector<std::string> m_snapshot_paths; /*!< Paths of the UCS database csv files, in snapshot id order */
+    std::vector<std::string> m_snapshot_labels; /*!< m_snapshot_paths as csv fields, quoted where needed */
+    std::vector<size_t> m_snapshot_rows; /*!< Number of rows of each snapshot */
+    ucs_ingest_options_t m_ingest_options; /*!< Options the snapshots were read with, reused to materialize more columns */
+    UCSSatelliteColumns m_columns; /*!< Column store holding every satellite that makes up this database */
     double m_eccentricity_qualifier; /*!< Max allowed eccentricity value */
+    UCSBitmask m_statistics_rows; /*!< Rows whose result columns have been filled by the batch kernel */
+    std::vector<uint32_t> m_selection; /*!< Selection vector: the qualifying rows, in row order */
+    bool m_selection_valid = false; /*!< Whether m_selection matches the current qualification */
+    bool m_loaded_from_cache = false; /*!< Whether the columns came from a binary snapshot instead of the text file */
+    UCSFieldParser m_field_parser; /*!< Numeric field parser; keeps the diagnostics for every malformed field (row ids are per snapshot) */
+
+    static void load_snapshot(const std::string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options,
+                              std::ostream &log, parsed_snapshot_t &snapshot);
+    static void load_csv(const std::string &csv_path, double eccentricity_qualifier, parsed_snapshot_t &snapshot);
+    static void load_mapped_csv(const std::string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options,
+                                std::ostream &log, parsed_snapshot_t &snapshot);
+    static void parse_chunks(UCSRowTokenizer &tokenizer, UCSSanitizer *sanitizer, double eccentricity_qualifier, ThreadPool &pool,
+                             parsed_snapshot_t &snapshot);
+    static void parse_rows(UCSRowTokenizer &tokenizer, UCSSanitizer *sanitizer, double eccentricity_qualifier,
+                           UCSSatelliteColumns &columns, UCSFieldParser &parser);
+    void ensure_statistics(const std::vector<uint32_t> &rows);
+    void materialize_columns(ucs_column_set_t columns);
 public:
-    UCSSatelliteDatabase(const std::string &csv_path, double eccentricity_qualifier);
+    UCSSatelliteDatabase(const std::string &csv_path, double eccentricity_qualifier, const ucs_ingest_options_t &options = {});
+    UCSSatelliteDatabase(const std::vector<std::string> &csv_paths, double eccentricity_qualifier, const ucs_ingest_options_t &options = {});
     ~UCSSatelliteDatabase();
 
     void compute_kepler_statistics();
     void dump_kepler_data_to_csv(std::string& path);
+    ecm_analysis_t analyze_to_csv(std::string& path, ThreadPool* pool = nullptr, mass_percentiles_t* percentiles = nullptr,
+                                  std::vector<mass_percentiles_t>* snapshot_percentiles = nullptr);
     void set_eccentricity_qualifier(double qualifier) { m_eccentricity_qualifier = qualifier; };
     void update_satellite_qualification();
     void compute_secondary_method();
+    void compute_sweep_statistics();
+    const std::vector<uint32_t>& get_selection();
 
     int get_disqualified_satellite_count() const;
-    int get_satellite_count() { return m_satellites.size(); }
+    int get_satellite_count() const { return static_cast<int>(m_columns.size()); }
+    UCSSatelliteEntry get_satellite(size_t row) { materialize_columns(UCS_COLUMNS_ALL); return {m_columns, row}; }
+    const UCSSatelliteColumns& get_columns() const { return m_columns; }
+    const std::vector<field_diagnostic_t>& get_parse_diagnostics() const { return m_field_parser.get_diagnostics(); }
+    bool was_loaded_from_cache() const { return m_loaded_from_cache; }
+    int get_snapshot_count() const { return static_cast<int>(m_snapshot_paths.size()); }
+    const std::string& get_snapshot_path(int snapshot_id) const { return m_snapshot_paths[snapshot_id]; }
+    const std::string& get_snapshot_label(int snapshot_id) const { return m_snapshot_labels[snapshot_id]; }
+    int get_snapshot_satellite_count(int snapshot_id) const { return static_cast<int>(m_snapshot_rows[snapshot_id]); }
 
     std::vector<mass_t> get_mass_estimations();
     std::vector<mass_t> get_secondary_mass_estimations();
+    void get_mass_estimations(std::vector<mass_t>& buffer);
+    void get_secondary_mass_estimations(std::vector<mass_t>& buffer);
+    UCSColumnView view_mass_estimations();
+    UCSColumnView view_secondary_mass_estimations();
+    UCSColumnView view_kepler_x();
+    UCSColumnView view_kepler_y();
+    UCSColumnView view_perigees();
+    UCSColumnView view_apogees();
+    UCSColumnView view_periods();
 };
 
 
@@ -7,44 +7,38 @@
 
 #include <iostream>
 #include <iomanip>
-#include "candidate_satellite_t.h"
-
-typedef double kepler_relation_coord_t;
-typedef double mass_t;
-typedef double velocity_t;
+#include "UCSSatelliteColumns.h"
+#include "Settings.h"
 
 /**
- * This class holds a single satellite entry from the UCS satellite database. It only
- * contains relevant parameters.
+ * This class is a view of a single satellite entry from the UCS satellite database. The data itself
+ * lives in a UCSSatelliteColumns store; an entry only remembers which row it refers to, so it is
+ * cheap to create and must not outlive the store.
  */
 class UCSSatelliteEntry
 {
 private:
-    bool m_qualifying; /*!< Whether this satellite qualifies for calculations */
-    int m_disqualification_reason; /*!< Why the satellite is disqualified, if that is the case */
-    std::string m_orbit_class; /*!< Variable(s) from UCS DB */
-    int m_satellite_row_id; /*!< Row number in the UCS DB */
-    double m_longitude, m_perigee, m_apogee, m_eccentricity, m_inclination, m_period, m_launch_mass;/*!< Variable(s) from UCS DB*/
-    kepler_relation_coord_t m_kepler_x = 0; /*!< Computed Kepler x-coordinate */
-    kepler_relation_coord_t m_kepler_y = 0; /*!< Computed Kepler y-coordinate */
-    mass_t kepler_mass = 0; /*!< Estimation of the mass of the Earth using these orbital parameters */
-    mass_t secondary_mass = 0; /*!< Estimation of the mass of the Earth (secondary method) */
-    velocity_t m_satellite_velocity = 0; /*! <Estimation of the satellite's velocity from its period (ms-1) */
+    const UCSSatelliteColumns* m_columns; /*!< Store that holds this satellite's data */
+    size_t m_row; /*!< Row of this satellite in m_columns */
 public:
-    explicit UCSSatelliteEntry(candidate_satellite_t& sat);
-    ~UCSSatelliteEntry();
-
-    [[maybe_unused]] void whoami();
-    void compute_kepler_statistics();
-    void estimate_orbital_velocity();
-    void estimate_earth_mass_method_2();
-
-    inline bool isQualified() const { return m_qualifying; };
-    inline double getKeplerX() const { return m_kepler_x; };
-    inline double getKeplerY() const { return m_kepler_y; };
-    inline mass_t getKeplerMass() const { return kepler_mass; };
-    inline mass_t getSecondaryMass() const { return secondary_mass; };
-    inline void update_satellite_qualification(double new_eccentricity_qualifier) { if (new_eccentricity_qualifier != 0) { m_qualifying = (m_eccentricity <= new_eccentricity_qualifier); } else { m_qualifying = (m_eccentricity == 0); } };
+    UCSSatelliteEntry(const UCSSatelliteColumns& columns, size_t row) : m_columns(&columns), m_row(row) {};
+
+    [[maybe_unused]] void whoami() const;
+
+    inline bool isQualified() const { return m_columns->qualifying.test(m_row); };
+    inline int getDisqualificationReason() const { return m_columns->disqualification_reason(m_row); };
+    inline int getSatelliteRowId() const { return m_columns->satellite_row_id[m_row]; };
+    inline const std::string& getOrbitClass() const { return m_columns->category(UCS_CATEGORY_ORBIT_CLASS, m_row); };
+    inline const std::string& getCountry() const { return m_columns->category(UCS_CATEGORY_COUNTRY, m_row); };
+    inline const std::string& getOperator() const { return m_columns->category(UCS_CATEGORY_OPERATOR, m_row); };
+    inline const std::string& getUsers() const { return m_columns->category(UCS_CATEGORY_USERS, m_row); };
+    inline const std::string& getPurpose() const { return m_columns->category(UCS_CATEGORY_PURPOSE, m_row); };
+    inline double getEccentricity() const { return m_columns->eccentricity[m_row]; };
+    inline double getKeplerX() const { return m_columns->kepler_x[m_row]; };
+    inline double getKeplerY() const { return m_columns->kepler_y[m_row]; };
+    inline mass_t getKeplerMass() const { return m_columns->kepler_mass[m_row]; };
+    inline mass_t getSecondaryMass() const { return m_columns->secondary_mass[m_row]; };
+    inline velocity_t getSatelliteVelocity() const { return m_columns->satellite_velocity[m_row]; };
 };
 
 
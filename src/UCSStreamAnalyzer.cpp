@@ -0,0 +1,118 @@
+#include "UCSStreamAnalyzer.h"
+#include "include/csv.h"
+#include "Settings.h"
+#include "UCSRowTokenizer.h"
+#include "UCSSanitizer.h"
+#include "UCSDecompressingByteSource.h"
+#include <cstring>
+#include <memory>
+
+using string = std::string;
+
+/**
+ * @param eccentricity_qualifier Maximum eccentricity value allowed to be a qualifier satellite
+ * @param options                Selects the sanitizer stage; the other ingest settings do not apply to streams
+ * @param log                    Where diagnostics and the sanitizer report are written
+ */
+UCSStreamAnalyzer::UCSStreamAnalyzer(double eccentricity_qualifier, const ucs_ingest_options_t &options, std::ostream &log)
+    : m_eccentricity_qualifier(eccentricity_qualifier), m_options(options), m_log(log)
+{
+    m_batch.reserve(STREAM_BATCH_ROWS);
+    m_batch.materialized = options.columns;
+    m_field_parser.set_diagnostic_limit(MAX_REPORTED_FIELD_ERRORS);
+}
+
+/**
+ * Reads the whole input, writing one output row per qualifying satellite as its batch completes.
+ *
+ * @param input_path UCS database file to read, or "-" for stdin
+ * @param output     Receives the CSV rows, header first
+ * @return The statistics of every qualifying satellite. The medians come from quantile sketches, so past
+ *         QUANTILE_SKETCH_K qualifying satellites they are approximate (see QuantileSketch)
+ * @throws io::error::base if the input cannot be read or a line has the wrong number of columns
+ */
+ecm_analysis_t UCSStreamAnalyzer::run(const string &input_path, std::ostream &output)
+{
+    std::unique_ptr<io::LineReader> reader;
+
+    compression_t compression = (input_path == "-") ? compression_t::none : UCSDecompressingByteSource::detect_compression(input_path);
+
+    // Compressed files are decompressed by the byte source, on csv.h's reader thread.
+    if (input_path == "-")
+        reader = std::make_unique<io::LineReader>("stdin", std::cin);
+    else if (compression != compression_t::none)
+        reader = std::make_unique<io::LineReader>(input_path, std::make_unique<UCSDecompressingByteSource>(input_path, compression));
+    else
+        reader = std::make_unique<io::LineReader>(input_path);
+
+    // The header is the first line that is not a comment.
+    char* raw_line;
+
+    do {
+        raw_line = reader->next_line();
+    } while (raw_line != nullptr && raw_line[0] == '#');
+
+    if (raw_line == nullptr)
+    {
+        io::error::header_missing err;
+        err.set_file_name(input_path.c_str());
+        throw err;
+    }
+
+    UCSRowTokenizer tokenizer(std::string_view(raw_line), input_path);
+    tokenizer.read_header();
+
+    std::unique_ptr<UCSSanitizer> sanitizer;
+
+    if (m_options.sanitize)
+        sanitizer = std::make_unique<UCSSanitizer>(tokenizer.get_header_line(), m_options.sanitized_output_path, m_log);
+
+    output << "x,y,mass_estimation_kepler,mass_estimation_secondary" << std::endl;
+
+    candidate_satellite_view_t candidate_satellite {};
+    candidate_satellite.eccentricity_qualifier = m_eccentricity_qualifier;
+
+    while ((raw_line = reader->next_line()) != nullptr)
+    {
+        if (raw_line[0] == '#')
+            continue;
+
+        std::string_view line(raw_line, std::strlen(raw_line));
+        tokenizer.set_file_line(reader->get_file_line());
+
+        if (sanitizer && !sanitizer->check_delimiters(line, tokenizer.get_file_line()))
+            continue;
+
+        tokenizer.split_row(line, candidate_satellite);
+
+        if (sanitizer && !sanitizer->rewrite_eccentricity(line, candidate_satellite, tokenizer.get_file_line()))
+            continue;
+
+        candidate_satellite.p_satellite_row_id = ++m_satellite_count;
+        m_batch.append(candidate_satellite, m_field_parser);
+
+        if (m_batch.size() == STREAM_BATCH_ROWS)
+            flush_batch(output);
+    }
+
+    flush_batch(output);
+
+    m_field_parser.report(m_log, MAX_REPORTED_FIELD_ERRORS);
+
+    if (sanitizer)
+        sanitizer->report();
+
+    return m_engine.result(m_eccentricity_qualifier, m_satellite_count);
+}
+
+/**
+ * Analyzes the rows in m_batch, writes and folds in the qualifying ones, and empties the batch.
+ */
+void UCSStreamAnalyzer::flush_batch(std::ostream &output)
+{
+    // Only the qualifying rows are computed and written.
+    m_batch.qualifying.select(m_selection);
+    m_engine.add(m_batch, m_selection.data(), m_selection.size(), &output);
+
+    m_batch.clear();
+}
@@ -0,0 +1,44 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCSSTREAMANALYZER_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCSSTREAMANALYZER_H
+
+#include <iostream>
+#include <string>
+#include "FusedAnalysisEngine.h"
+#include "UCSFieldParser.h"
+#include "UCSSatelliteColumns.h"
+#include "ecm_analysis_t.h"
+#include "ucs_ingest_options_t.h"
+
+/**
+ * Non-MEQ analysis in bounded memory. Instead of loading the whole database first, rows are read
+ * from a file or stdin into a small fixed-size batch; once the batch is full, a
+ * FusedAnalysisEngine pass computes, writes out and folds in its qualifying rows, and the batch
+ * is reused. Apart from the quantile sketches, which grow only logarithmically, memory use
+ * therefore does not grow with the input, however many rows it has.
+ *
+ * The output rows are identical to the ones UCSSatelliteDatabase::dump_kepler_data_to_csv writes.
+ */
+class UCSStreamAnalyzer
+{
+private:
+    double m_eccentricity_qualifier; /*!< Max allowed eccentricity value */
+    ucs_ingest_options_t m_options; /*!< Only the sanitizer settings are used */
+    std::ostream& m_log; /*!< Where diagnostics and the sanitizer report are written */
+    UCSSatelliteColumns m_batch; /*!< Rows read but not yet analyzed */
+    std::vector<uint32_t> m_selection; /*!< Qualifying rows of m_batch; reused from batch to batch */
+    UCSFieldParser m_field_parser; /*!< Keeps the details of the first few malformed fields only */
+    int m_satellite_count = 0; /*!< Rows read so far */
+    FusedAnalysisEngine m_engine; /*!< Analyzes each batch and keeps the running sums */
+
+    void flush_batch(std::ostream &output);
+public:
+    UCSStreamAnalyzer(double eccentricity_qualifier, const ucs_ingest_options_t &options, std::ostream &log);
+
+    ecm_analysis_t run(const std::string &input_path, std::ostream &output);
+
+    inline int get_satellite_count() const { return m_satellite_count; };
+    inline void get_percentiles(mass_percentiles_t& percentiles) const { m_engine.percentiles(percentiles); };
+};
+
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCSSTREAMANALYZER_H
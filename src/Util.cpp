@@ -10,6 +10,7 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include "RunningMoments.h"
 #include "Settings.h"
 
 using string = std::string;
@@ -89,13 +90,7 @@ namespace Util_fn
  */
     static double vector_standard_deviation(std::vector<double>& v)
     {
-        double buf = 0;
-        double mean = vector_mean(v);
-
-        for (double element : v)
-            buf += pow(element - mean, 2);
-
-        return sqrt(buf / v.size());
+        return moments_of(v.data(), v.size()).standard_deviation();
     }
 }
 
@@ -21,6 +21,10 @@ struct candidate_satellite_t {
     std::string p_inclination;
     std::string p_period;
     std::string p_launch_mass;
+    std::string p_country; /*!< Optional; empty when the database has no such column */
+    std::string p_operator; /*!< Optional */
+    std::string p_users; /*!< Optional */
+    std::string p_purpose; /*!< Optional */
     double eccentricity_qualifier;
 };
 
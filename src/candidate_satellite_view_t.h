@@ -0,0 +1,27 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_CANDIDATE_SATELLITE_VIEW_T_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_CANDIDATE_SATELLITE_VIEW_T_H
+
+#include <string_view>
+
+/**
+ * Non-owning counterpart of candidate_satellite_t. Every field points straight into the
+ * buffer the row was tokenized from, so the buffer must outlive this struct.
+ */
+struct candidate_satellite_view_t {
+    int p_satellite_row_id;
+    std::string_view p_orbit_class;
+    std::string_view p_longitude;
+    std::string_view p_perigee;
+    std::string_view p_apogee;
+    std::string_view p_eccentricity;
+    std::string_view p_inclination;
+    std::string_view p_period;
+    std::string_view p_launch_mass;
+    std::string_view p_country; /*!< Optional; empty when the database has no such column */
+    std::string_view p_operator; /*!< Optional */
+    std::string_view p_users; /*!< Optional */
+    std::string_view p_purpose; /*!< Optional */
+    double eccentricity_qualifier;
+};
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_CANDIDATE_SATELLITE_VIEW_T_H
@@ -22,6 +22,12 @@ struct ecm_analysis_t {
     double sec_percent_error_mean;
     double sec_percent_error_median;
     int    sats_disqualified;
+    double regression_slope; /*!< least-squares slope of kepler_y against kepler_x */
+    double regression_intercept;
+    double regression_r_squared;
+    double regression_slope_std_error;
+    double regression_mass; /*!< Earth mass implied by the slope (kepler_y = kepler_x / mass) */
+    double regression_percent_error;
 };
 
 #endif //CPP_SATELLITE_ANALYZER_PROJECT_ECM_ANALYSIS_T_H
@@ -14,13 +14,29 @@
  * Usage: cpp-satellite-analyzer [options]
  *
  * Arguments:
- * --input     	input CSV file for this analysis action[Required]
+ * --input     	input CSV file(s) for this analysis action; a quoted glob pattern loads every matching snapshot[Required]
  * --output    	output CSV file for this analysis action[Required]
  * --ecc       	eccentricity qualifier (for non-MEQ mode)
  * --meq       	enter multiple eccentricity qualifier mode
  * --meq-min   	minimum eccentricity (for MEQ mode)
  * --meq-max   	maximum eccentricity (for MEQ mode)
  * --meq-steps 	number of steps (for MEQ mode)
+ * --meq-exact 	evaluate MEQ mode at every distinct eccentricity between --meq-min and --meq-max instead of --meq-steps
+ * --mmap      	parse the input through a read-only memory mapping (zero-copy)
+ * --sanitize  	sanitize the raw input while parsing it (replaces preprocess.py; implies --mmap)
+ * --sanitized-output	also write the sanitized database to this file (with --sanitize)
+ * --stream    	non-MEQ analysis in bounded memory: rows are analyzed and written as they are read (--input/--output may be - for stdin/stdout)
+ * --parallel-ingest	parse the input in chunks across the --threads workers (implies --mmap)
+ * --cache     	binary column snapshot of the parsed input; reused while the input is unchanged, (re)written otherwise
+ * --kernel    	instruction set for the batch kernels (scalar, sse2, avx2, avx512; default: widest supported)
+ * --threads   	number of worker threads (0 = one per hardware thread; default: 1)
+ * --bootstrap 	bootstrap resamples for confidence intervals of the mean, median and regression slope (0 = off; not with --stream)
+ * --bootstrap-seed	seed of the bootstrap resampling (default: 1)
+ * --mc-trials 	Monte Carlo trials propagating the input rounding errors to the mass estimates (0 = off; not with --stream)
+ * --mc-model  	error model of the Monte Carlo inputs: uniform (rounding) or normal (default: uniform)
+ * --mc-altitude-error	half-width (uniform) or standard deviation (normal) of the perigee/apogee errors in km (default: 0.5)
+ * --mc-period-error	half-width (uniform) or standard deviation (normal) of the period errors in minutes (default: 0.005)
+ * --mc-seed   	seed of the Monte Carlo perturbations (default: 1)
  * 
  * @copyright (c) 2020 Joseph Azrak
  * @author Joseph Azrak
@@ -33,13 +49,20 @@
 #include <chrono>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <set>
+#include <glob.h>
 #include "include/csv.h"
 #include "include/loguru.cpp"
 #include "include/argparse.hpp"
 #include "Settings.h"
 #include "Util.cpp"
 #include "UCSSatelliteDatabase.h"
+#include "KeplerKernels.h"
+#include "MEQSweepEngine.h"
+#include "UCSStreamAnalyzer.h"
+#include "BootstrapEngine.h"
+#include "MonteCarloEngine.h"
 #include "ecm_analysis_t.h"
 
 using string = std::string;
@@ -47,6 +70,8 @@ using string = std::string;
 typedef string filename_t;
 
 bool file_exists(const string& filename);
+std::vector<filename_t> expand_input_pattern(const string& pattern);
+void log_percentiles(const mass_percentiles_t& percentiles);
 
 bool file_exists(const string& filename)
 {
@@ -54,6 +79,48 @@ bool file_exists(const string& filename)
     return infile.good();
 }
 
+/**
+ * Expands an --input value into the input files it names. The value is a glob pattern, and may
+ * list alternatives in braces, e.g. "releases/UCS_{2019,2020}_*.txt"; matches come back sorted by name.
+ * A value that matches nothing but names an existing file is returned as is.
+ */
+std::vector<filename_t> expand_input_pattern(const string& pattern)
+{
+    std::vector<filename_t> files;
+    glob_t matches;
+
+    if (glob(pattern.c_str(), GLOB_BRACE | GLOB_TILDE, nullptr, &matches) == 0)
+    {
+        for (size_t i = 0; i < matches.gl_pathc; ++i)
+            files.emplace_back(matches.gl_pathv[i]);
+    }
+
+    globfree(&matches);
+
+    if (files.empty() && file_exists(pattern))
+        files.push_back(pattern);
+
+    return files;
+}
+
+/**
+ * Logs the REPORTED_QUANTILES of both mass estimations, one line per method. They come from
+ * quantile sketches and are approximate past QUANTILE_SKETCH_K values.
+ */
+void log_percentiles(const mass_percentiles_t& percentiles)
+{
+    std::ostringstream kepler, secondary;
+
+    for (size_t i = 0; i < REPORTED_QUANTILE_COUNT; ++i)
+    {
+        kepler << " p" << REPORTED_QUANTILES[i] * 100 << " " << percentiles.kepler[i];
+        secondary << " p" << REPORTED_QUANTILES[i] * 100 << " " << percentiles.secondary[i];
+    }
+
+    LOG_S(INFO) << "Kepler mass percentiles (approx.):" << kepler.str();
+    LOG_S(INFO) << "Secondary mass percentiles (approx.):" << secondary.str();
+}
+
 int main(int argc, char **argv)
 {
     loguru::init(argc, argv);
@@ -65,15 +132,7 @@ int main(int argc, char **argv)
 
     program.add_argument("--input")
             .required()
-            .help("input CSV file for this analysis action")
-            .action([](const std::string &value) {
-                if (!file_exists(value))
-                {
-                    LOG_S(ERROR) << "The file " << value << " does not exist. ";
-                    exit(1);
-                }
-                return value;
-            });
+            .help("input CSV file(s) for this analysis action; a quoted glob pattern loads every matching snapshot");
 
     program.add_argument("--output")
         .required()
@@ -103,14 +162,112 @@ int main(int argc, char **argv)
         .default_value(string("NA"))
         .help("number of steps (for MEQ mode)");
 
+    program.add_argument("--meq-exact")
+            .help("evaluate MEQ mode at every distinct eccentricity between --meq-min and --meq-max")
+            .default_value(false)
+            .implicit_value(true);
+
+    program.add_argument("--mmap")
+            .help("parse the input through a read-only memory mapping (zero-copy)")
+            .default_value(false)
+            .implicit_value(true);
+
+    program.add_argument("--sanitize")
+            .help("sanitize the raw input while parsing it (replaces preprocess.py; implies --mmap)")
+            .default_value(false)
+            .implicit_value(true);
+
+    program.add_argument("--sanitized-output")
+        .default_value(string(""))
+        .help("also write the sanitized database to this file (with --sanitize)");
+
+    program.add_argument("--stream")
+            .help("non-MEQ analysis in bounded memory: rows are analyzed and written as they are read (--input/--output may be - for stdin/stdout)")
+            .default_value(false)
+            .implicit_value(true);
+
+    program.add_argument("--parallel-ingest")
+            .help("parse the input in chunks across the --threads workers (implies --mmap)")
+            .default_value(false)
+            .implicit_value(true);
+
+    program.add_argument("--cache")
+        .default_value(string(""))
+        .help("binary column snapshot of the parsed input; reused while the input is unchanged, (re)written otherwise");
+
+    program.add_argument("--kernel")
+        .default_value(string(Kepler_fn::isa_name(Kepler_fn::detect_isa())))
+        .help("instruction set for the batch kernels (scalar, sse2, avx2, avx512)");
+
+    program.add_argument("--threads")
+        .help("number of worker threads (0 = one per hardware thread)")
+        .default_value(1)
+        .action([](const std::string &value) {
+            return std::stoi(value);
+        });
+
+    program.add_argument("--bootstrap")
+        .help("bootstrap resamples for confidence intervals of the mean, median and regression slope (0 = off)")
+        .default_value(0)
+        .action([](const std::string &value) {
+            return std::stoi(value);
+        });
+
+    program.add_argument("--bootstrap-seed")
+        .help("seed of the bootstrap resampling")
+        .default_value(1)
+        .action([](const std::string &value) {
+            return std::stoi(value);
+        });
+
+    program.add_argument("--mc-trials")
+        .help("Monte Carlo trials propagating the input rounding errors to the mass estimates (0 = off)")
+        .default_value(0)
+        .action([](const std::string &value) {
+            return std::stoi(value);
+        });
+
+    program.add_argument("--mc-model")
+        .default_value(string("uniform"))
+        .help("error model of the Monte Carlo inputs: uniform (rounding) or normal");
+
+    program.add_argument("--mc-altitude-error")
+        .help("half-width (uniform) or standard deviation (normal) of the perigee/apogee errors in km")
+        .default_value(0.5)
+        .action([](const std::string &value) {
+            return std::stod(value);
+        });
+
+    program.add_argument("--mc-period-error")
+        .help("half-width (uniform) or standard deviation (normal) of the period errors in minutes")
+        .default_value(0.005)
+        .action([](const std::string &value) {
+            return std::stod(value);
+        });
+
+    program.add_argument("--mc-seed")
+        .help("seed of the Monte Carlo perturbations")
+        .default_value(1)
+        .action([](const std::string &value) {
+            return std::stoi(value);
+        });
+
     filename_t sOutputFile;
     filename_t sInputFile;
+    std::vector<filename_t> vInputFiles;
     bool bIsMeqMode = false;
-    double dMeqMin;
-    double dMeqMax;
-    double dMeqStepSize;
-    int iMeqSteps;
+    bool bIsMeqExact = false;
+    bool bIsStreamMode = false;
+    double dMeqMin = 0;
+    double dMeqMax = 0;
+    double dMeqStepSize = 0;
+    int iMeqSteps = 0;
     double dEccentricityQualifier;
+    ucs_ingest_options_t ingestOptions;
+    int iThreads;
+    int iBootstrapResamples;
+    int iMonteCarloTrials;
+    uncertainty_model_t uncertaintyModel;
 
     try {
         program.parse_args(argc, argv);
@@ -120,9 +277,83 @@ int main(int argc, char **argv)
     }
 
     bIsMeqMode = program.get<bool>("--meq");
+    bIsMeqExact = program.get<bool>("--meq-exact");
+    bIsStreamMode = program.get<bool>("--stream");
     sInputFile = program.get<string>("--input");
+    vInputFiles = (bIsStreamMode && sInputFile == "-") ? std::vector<filename_t> {sInputFile} : expand_input_pattern(sInputFile);
     sOutputFile = program.get<string>("--output");
     dEccentricityQualifier = program.get<double>("--ecc");
+    ingestOptions.memory_mapped = program.get<bool>("--mmap");
+    ingestOptions.sanitize = program.get<bool>("--sanitize");
+    ingestOptions.sanitized_output_path = program.get<string>("--sanitized-output");
+    ingestOptions.cache_path = program.get<string>("--cache");
+    ingestOptions.chunked = program.get<bool>("--parallel-ingest");
+    // The analysis only reads the Kepler inputs; the other columns are validated but not converted.
+    ingestOptions.columns = UCS_COLUMNS_KEPLER_ANALYSIS;
+
+    if (vInputFiles.empty())
+    {
+        LOG_S(ERROR) << "The file " << sInputFile << " does not exist. ";
+        exit(1);
+    }
+
+    if (!ingestOptions.sanitized_output_path.empty() && !ingestOptions.sanitize)
+    {
+        LOG_S(ERROR) << "--sanitized-output can only be used together with --sanitize";
+        exit(1);
+    }
+
+    if (bIsStreamMode && (bIsMeqMode || ingestOptions.chunked || !ingestOptions.cache_path.empty() || vInputFiles.size() > 1))
+    {
+        LOG_S(ERROR) << "--stream reads a single input and cannot be combined with --meq, --parallel-ingest or --cache";
+        exit(1);
+    }
+
+    if (!ingestOptions.sanitized_output_path.empty() && vInputFiles.size() > 1)
+    {
+        LOG_S(ERROR) << "--sanitized-output can only be used with a single input file";
+        exit(1);
+    }
+    iThreads = program.get<int>("--threads");
+
+    if (iThreads < 0)
+    {
+        LOG_S(ERROR) << "--threads must be zero or positive";
+        exit(1);
+    }
+
+    iBootstrapResamples = program.get<int>("--bootstrap");
+
+    if (iBootstrapResamples < 0 || (iBootstrapResamples > 0 && bIsStreamMode))
+    {
+        LOG_S(ERROR) << "--bootstrap must be zero or positive and cannot be combined with --stream";
+        exit(1);
+    }
+
+    iMonteCarloTrials = program.get<int>("--mc-trials");
+    uncertaintyModel.normal = program.get<string>("--mc-model") == "normal";
+    uncertaintyModel.altitude_error = program.get<double>("--mc-altitude-error") * 1000; // CONVERSION from km to m.
+    uncertaintyModel.period_error = program.get<double>("--mc-period-error") * 60; // CONVERSION from minutes to seconds.
+
+    if (iMonteCarloTrials < 0 || (iMonteCarloTrials > 0 && (bIsStreamMode || bIsMeqMode)))
+    {
+        LOG_S(ERROR) << "--mc-trials must be zero or positive and can only be used in non-MEQ mode without --stream";
+        exit(1);
+    }
+
+    if (!uncertaintyModel.normal && program.get<string>("--mc-model") != "uniform")
+    {
+        LOG_S(ERROR) << "The error model " << program.get<string>("--mc-model") << " is unknown (uniform, normal)";
+        exit(1);
+    }
+
+    kernel_isa_t kernelIsa;
+
+    if (!Kepler_fn::parse_isa(program.get<string>("--kernel"), kernelIsa) || !Kepler_fn::set_active_isa(kernelIsa))
+    {
+        LOG_S(ERROR) << "The instruction set " << program.get<string>("--kernel") << " is unknown or not supported by this CPU";
+        exit(1);
+    }
 
     if (bIsMeqMode)
     {
@@ -132,8 +363,13 @@ int main(int argc, char **argv)
         try {
             dMeqMin = std::stod(program.get<string>("--meq-min"));
             dMeqMax = std::stod(program.get<string>("--meq-max"));
-            iMeqSteps = std::stoi(program.get<string>("--meq-steps"));
-            dMeqStepSize = (dMeqMax - dMeqMin) / iMeqSteps;
+
+            // In exact mode, the steps are the breakpoints found in the data.
+            if (!bIsMeqExact)
+            {
+                iMeqSteps = std::stoi(program.get<string>("--meq-steps"));
+                dMeqStepSize = (dMeqMax - dMeqMin) / iMeqSteps;
+            }
         } catch (const std::invalid_argument& error) {
             LOG_S(ERROR) << "Argument parse failed. You might be missing an argument for MEQ-mode: " << error.what();
             exit(1);
@@ -148,6 +384,51 @@ int main(int argc, char **argv)
         }
     }
 
+    if (bIsStreamMode)
+    {
+        // ----------------------------------------------------------------------
+        //                      STREAMING MODE LOGIC BEGIN
+        // ----------------------------------------------------------------------
+        // Rows are analyzed in small batches as they are read, so the database is never held
+        // in memory. When the results go to stdout, the parse reports go to stderr instead.
+        bool bOutputToStdout = sOutputFile == "-";
+        std::ofstream output_fstream;
+
+        if (!bOutputToStdout)
+            output_fstream.open(sOutputFile);
+
+        std::ostream& output_stream = bOutputToStdout ? std::cout : output_fstream;
+        UCSStreamAnalyzer stream_analyzer(dEccentricityQualifier, ingestOptions, bOutputToStdout ? std::cerr : std::cout);
+        ecm_analysis_t summary {};
+
+        try {
+            summary = stream_analyzer.run(vInputFiles[0], output_stream);
+        } catch (const io::error::base& error) {
+            LOG_S(ERROR) << "Parse failed! " << error.what();
+            exit(1);
+        } catch (const std::runtime_error& error) {
+            LOG_S(ERROR) << "Parse failed! " << error.what();
+            exit(1);
+        }
+
+        output_stream.flush();
+
+        LOG_S(INFO) << "Finished streaming analysis of " << stream_analyzer.get_satellite_count() << " satellite(s), "
+                    << (stream_analyzer.get_satellite_count() - summary.sats_disqualified) << " qualified";
+        LOG_S(INFO) << "Kepler mass: mean " << summary.kepler_mean << ", approx. median " << summary.kepler_median
+                    << ", std dev " << summary.kepler_precision << ", " << summary.kepler_percent_error_mean << "% error";
+        LOG_S(INFO) << "Secondary mass: mean " << summary.sec_mean << ", approx. median " << summary.sec_median
+                    << ", std dev " << summary.sec_precision << ", " << summary.sec_percent_error_mean << "% error";
+        LOG_S(INFO) << "Kepler regression: slope " << summary.regression_slope << " (std err " << summary.regression_slope_std_error
+                    << "), intercept " << summary.regression_intercept << ", R^2 " << summary.regression_r_squared;
+        LOG_S(INFO) << "Regression mass: " << summary.regression_mass << ", " << summary.regression_percent_error << "% error";
+
+        mass_percentiles_t percentiles;
+        stream_analyzer.get_percentiles(percentiles);
+        log_percentiles(percentiles);
+        return 0;
+    }
+
     // At this point, we have input/output paths, eccentricity qualifier, and MEQ parameters
     // (if needed). First, parse the CSV file as this is common to both MEQ and
     // non-MEQ operations.
@@ -156,7 +437,17 @@ int main(int argc, char **argv)
     // MEQ mode by design varies this eccentricity qualifier anyway, using
     // UCSSatelliteDatabase::update_satellite_qualification().
 
-    UCSSatelliteDatabase satellite_database(sInputFile, dEccentricityQualifier);
+    ThreadPool worker_pool(static_cast<unsigned>(iThreads));
+    ingestOptions.pool = &worker_pool;
+
+    UCSSatelliteDatabase satellite_database(vInputFiles, dEccentricityQualifier, ingestOptions);
+    BootstrapEngine bootstrap(worker_pool, iBootstrapResamples, BOOTSTRAP_CONFIDENCE, static_cast<uint64_t>(program.get<int>("--bootstrap-seed")));
+
+    if (satellite_database.was_loaded_from_cache())
+        LOG_S(INFO) << "Loaded " << satellite_database.get_satellite_count() << " satellite(s) from the column snapshot(s) at " << ingestOptions.cache_path;
+
+    if (satellite_database.get_snapshot_count() > 1)
+        LOG_S(INFO) << "Loaded " << satellite_database.get_snapshot_count() << " snapshots (" << satellite_database.get_satellite_count() << " satellites)";
 
     // DEBUG: Print all parsed args.
     // LOG_S(INFO) << "INP: " << sInputFile;
@@ -179,99 +470,197 @@ int main(int argc, char **argv)
         //                      MEQ MODE LOGIC BEGIN
         // ----------------------------------------------------------------------
 
-        std::vector<ecm_analysis_t> meq_result_vector {};
+        // The mass estimations do not depend on the eccentricity qualifier, so they are computed
+        // once, for every satellite that some step may let in. The sweep engine then only adds
+        // the satellites each step lets in.
+        satellite_database.compute_sweep_statistics();
 
-        for (int i = 0; i <= iMeqSteps; ++i)
-        {
-            // Tell the UCSSatelliteDatabase that we are updating the candidacy settings
-            // and reload the satellite qualification info.
-            satellite_database.set_eccentricity_qualifier(dMeqMin + dMeqStepSize * i);
-            satellite_database.update_satellite_qualification();
-
-            // Recompute Kepler and secondary statistics for these new candidacy settings.
-            satellite_database.compute_kepler_statistics();
-            satellite_database.compute_secondary_method();
-
-            // We have now computed a kepler/secondary result-set for this specific eccentricity-qualifier.
-            // Get some useful results from this simulation and save to ecm_analysis_t instance.
-            std::vector<double> kep_mass_estimations = satellite_database.get_mass_estimations();
-            std::vector<double> sec_mass_estimations = satellite_database.get_secondary_mass_estimations();
-
-            double kep_vec_mean      = Util_fn::vector_mean(kep_mass_estimations);
-            double kep_vec_median    = Util_fn::vector_median(kep_mass_estimations);
-            double kep_vec_precision = Util_fn::vector_standard_deviation(kep_mass_estimations);
-
-            double sec_vec_mean      = Util_fn::vector_mean(sec_mass_estimations);
-            double sec_vec_median    = Util_fn::vector_median(sec_mass_estimations);
-            double sec_vec_precision = Util_fn::vector_standard_deviation(sec_mass_estimations);
-
-            double kep_percent_error_mean         = abs(((kep_vec_mean - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
-            double kep_percent_error_median       = abs(((kep_vec_median - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
-            double kep_percent_standard_deviation = (kep_vec_precision / kep_vec_mean) * 100;
-
-            double sec_percent_error_mean         = abs(((sec_vec_mean - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
-            double sec_percent_error_median       = abs(((sec_vec_median - LITERATURE_VALUE) / (LITERATURE_VALUE)) * 100);
-            double sec_percent_standard_deviation = (sec_vec_precision / sec_vec_mean) * 100;
-
-            ecm_analysis_t result = {
-                    (dMeqMin + dMeqStepSize * i), kep_vec_mean, kep_vec_median, kep_vec_precision, kep_percent_error_mean,
-                    kep_percent_error_median, kep_percent_standard_deviation, sec_vec_mean, sec_vec_median, sec_vec_precision,
-                    sec_percent_error_mean, sec_percent_error_median, satellite_database.get_disqualified_satellite_count()
-            };
-
-            // Stash this simulation result to the result-set vector.
-            meq_result_vector.push_back(result);
-        }
+        // With several snapshots loaded, the combined data is swept first and then every
+        // snapshot on its own; each result row says which of them it belongs to.
+        bool bPerSnapshot = satellite_database.get_snapshot_count() > 1;
 
-        // Now, we have a populated meq_result_vector with n = iMeqSteps simulation entries.
-        // We need to output this data to a csv file.
+        std::vector<int> meq_snapshots {MEQSweepIndex::ALL_SNAPSHOTS};
 
-        // In order to avoid duplicate entries
-        std::set<int> already_seen_rows {};
+        if (bPerSnapshot)
+            for (int snapshot = 0; snapshot < satellite_database.get_snapshot_count(); ++snapshot)
+                meq_snapshots.push_back(snapshot);
 
         // Open a file handle to the desired output file.
         std::ofstream csv_fstream;
         csv_fstream.open(sOutputFile);
-        csv_fstream << "max_eccentricity,kep_mass_mean,kep_mass_median,kep_mass_std_dev,kep_mass_std_dev_percent,kep_percent_error_mean,kep_percent_error_median,sec_mean,sec_median,sec_std_dev,sec_percent_error_mean,sec_percent_error_median,sats_disqualified,sats_used" << std::endl;
+        csv_fstream << (bPerSnapshot ? "snapshot," : "") << "max_eccentricity,kep_mass_mean,kep_mass_median,kep_mass_std_dev,kep_mass_std_dev_percent,kep_percent_error_mean,kep_percent_error_median,sec_mean,sec_median,sec_std_dev,sec_percent_error_mean,sec_percent_error_median,sats_disqualified,sats_used,reg_slope,reg_intercept,reg_r_squared,reg_slope_std_err,reg_mass,reg_percent_error"
+                    << (iBootstrapResamples > 0 ? ",kep_mean_ci_low,kep_mean_ci_high,kep_median_ci_low,kep_median_ci_high,sec_mean_ci_low,sec_mean_ci_high,sec_median_ci_low,sec_median_ci_high,reg_slope_ci_low,reg_slope_ci_high" : "")
+                    << std::endl;
 
-        for (ecm_analysis_t& result : meq_result_vector)
+        // Totals over every sweep, for the closing log line.
+        long long lMeqEvaluations = 0;
+        long long lMeqCalculations = 0;
+
+        for (int meq_snapshot : meq_snapshots)
         {
-            if (already_seen_rows.find(result.sats_disqualified) != already_seen_rows.end())
-                continue; // We have already seen this datapoint, do not export it.
-
-            csv_fstream
-                    << result.qualifier << ","
-                    << result.kepler_mean << ","
-                    << result.kepler_median << ","
-                    << result.kepler_precision << ","
-                    << result.kepler_percent_precision << ","
-                    << result.kepler_percent_error_mean << ","
-                    << result.kepler_percent_error_median << ","
-                    << result.sec_mean << ","
-                    << result.sec_median << ","
-                    << result.sec_precision << ","
-                    << result.sec_percent_error_mean << ","
-                    << result.sec_percent_error_median << ","
-                    << result.sats_disqualified << ","
-                    << (satellite_database.get_satellite_count() - result.sats_disqualified)
-                    << std::endl;
+            std::vector<ecm_analysis_t> meq_result_vector {};
+
+            MEQSweepIndex meq_index(satellite_database.get_columns(), meq_snapshot);
+            std::vector<double> meq_qualifiers;
+
+            if (bIsMeqExact)
+            {
+                // Only evaluate the qualifiers at which the qualified set actually changes.
+                meq_qualifiers = meq_index.breakpoints(dMeqMin, dMeqMax);
+                iMeqSteps = static_cast<int>(meq_qualifiers.size()) - 1;
+            } else {
+                for (int i = 0; i <= iMeqSteps; ++i)
+                    meq_qualifiers.push_back(dMeqMin + dMeqStepSize * i);
+            }
+
+            // Every worker sweeps its own blocks of steps over the same read-only index and writes
+            // its results straight into their slots, so the result-set stays in step order.
+            meq_result_vector = MEQSweepEngine::sweep(meq_index, meq_qualifiers, worker_pool);
+
+            int iSweptSatellites = meq_snapshot == MEQSweepIndex::ALL_SNAPSHOTS ? satellite_database.get_satellite_count()
+                                                                               : satellite_database.get_snapshot_satellite_count(meq_snapshot);
+            lMeqEvaluations += static_cast<long long>(meq_qualifiers.size());
+            lMeqCalculations += static_cast<long long>(meq_qualifiers.size()) * iSweptSatellites * 2;
+
+            // Now, we have a populated meq_result_vector with n = iMeqSteps simulation entries.
+            // We need to output this data to a csv file.
+
+            // In order to avoid duplicate entries
+            std::set<int> already_seen_rows {};
+
+            for (ecm_analysis_t& result : meq_result_vector)
+            {
+                if (already_seen_rows.find(result.sats_disqualified) != already_seen_rows.end())
+                    continue; // We have already seen this datapoint, do not export it.
+
+                if (bPerSnapshot)
+                    csv_fstream << (meq_snapshot == MEQSweepIndex::ALL_SNAPSHOTS ? string("combined") : satellite_database.get_snapshot_label(meq_snapshot)) << ",";
+
+                csv_fstream
+                        << result.qualifier << ","
+                        << result.kepler_mean << ","
+                        << result.kepler_median << ","
+                        << result.kepler_precision << ","
+                        << result.kepler_percent_precision << ","
+                        << result.kepler_percent_error_mean << ","
+                        << result.kepler_percent_error_median << ","
+                        << result.sec_mean << ","
+                        << result.sec_median << ","
+                        << result.sec_precision << ","
+                        << result.sec_percent_error_mean << ","
+                        << result.sec_percent_error_median << ","
+                        << result.sats_disqualified << ","
+                        << (meq_index.satellite_count - result.sats_disqualified) << ","
+                        << result.regression_slope << ","
+                        << result.regression_intercept << ","
+                        << result.regression_r_squared << ","
+                        << result.regression_slope_std_error << ","
+                        << result.regression_mass << ","
+                        << result.regression_percent_error;
+
+                if (iBootstrapResamples > 0)
+                {
+                    // Resample exactly the satellites this step qualified.
+                    size_t begin, end;
+                    meq_index.qualified_range(result.qualifier, begin, end);
+
+                    bootstrap_sample_t sample = {
+                            meq_index.kepler_mass.data() + begin, meq_index.secondary_mass.data() + begin,
+                            meq_index.kepler_x.data() + begin, meq_index.kepler_y.data() + begin, end - begin
+                    };
+                    ecm_bootstrap_t ci = bootstrap.run(sample);
+
+                    csv_fstream
+                            << "," << ci.kepler_mean.low << "," << ci.kepler_mean.high
+                            << "," << ci.kepler_median.low << "," << ci.kepler_median.high
+                            << "," << ci.sec_mean.low << "," << ci.sec_mean.high
+                            << "," << ci.sec_median.low << "," << ci.sec_median.high
+                            << "," << ci.regression_slope.low << "," << ci.regression_slope.high;
+                }
+
+                csv_fstream << std::endl;
 
-            already_seen_rows.insert(result.sats_disqualified);
+                already_seen_rows.insert(result.sats_disqualified);
+            }
         }
 
         csv_fstream.close();
 
         LOG_S(INFO) << "Finished MEQ operation!";
-        LOG_S(INFO) << "Completed " << iMeqSteps << " simulation(s) totalling approx " << satellite_database.get_satellite_count() * 2 * iMeqSteps << " calculations";
+        LOG_S(INFO) << "Completed " << lMeqEvaluations << " simulation(s) totalling approx " << lMeqCalculations << " calculations";
     } else {
         // ----------------------------------------------------------------------
         //                      NON-MEQ MODE LOGIC BEGIN
         // ----------------------------------------------------------------------
-        satellite_database.compute_kepler_statistics();
-        satellite_database.compute_secondary_method();
-        satellite_database.dump_kepler_data_to_csv(sOutputFile);
+        mass_percentiles_t percentiles;
+        std::vector<mass_percentiles_t> snapshot_percentiles;
+        bool bPerSnapshot = satellite_database.get_snapshot_count() > 1;
+        ecm_analysis_t summary = satellite_database.analyze_to_csv(sOutputFile, &worker_pool, &percentiles,
+                                                                   bPerSnapshot ? &snapshot_percentiles : nullptr);
 
         LOG_S(INFO) << "Finished analysis operation!";
+        LOG_S(INFO) << "Kepler mass: mean " << summary.kepler_mean << ", approx. median " << summary.kepler_median
+                    << ", std dev " << summary.kepler_precision << ", " << summary.kepler_percent_error_mean << "% error";
+        LOG_S(INFO) << "Secondary mass: mean " << summary.sec_mean << ", approx. median " << summary.sec_median
+                    << ", std dev " << summary.sec_precision << ", " << summary.sec_percent_error_mean << "% error";
+        LOG_S(INFO) << "Kepler regression: slope " << summary.regression_slope << " (std err " << summary.regression_slope_std_error
+                    << "), intercept " << summary.regression_intercept << ", R^2 " << summary.regression_r_squared;
+        LOG_S(INFO) << "Regression mass: " << summary.regression_mass << ", " << summary.regression_percent_error << "% error";
+        log_percentiles(percentiles);
+
+        for (size_t snapshot = 0; snapshot < snapshot_percentiles.size(); ++snapshot)
+        {
+            LOG_S(INFO) << "Snapshot " << satellite_database.get_snapshot_path(static_cast<int>(snapshot)) << ":";
+            log_percentiles(snapshot_percentiles[snapshot]);
+        }
+
+        if (iBootstrapResamples > 0)
+        {
+            std::vector<mass_t> kepler_mass, secondary_mass;
+            std::vector<double> kepler_x, kepler_y;
+
+            satellite_database.get_mass_estimations(kepler_mass);
+            satellite_database.get_secondary_mass_estimations(secondary_mass);
+            satellite_database.view_kepler_x().copy_to(kepler_x);
+            satellite_database.view_kepler_y().copy_to(kepler_y);
+
+            bootstrap_sample_t sample = {kepler_mass.data(), secondary_mass.data(), kepler_x.data(), kepler_y.data(), kepler_mass.size()};
+            ecm_bootstrap_t ci = bootstrap.run(sample);
+
+            LOG_S(INFO) << BOOTSTRAP_CONFIDENCE * 100 << "% bootstrap intervals (" << iBootstrapResamples << " resamples):";
+            LOG_S(INFO) << "    Kepler mass mean [" << ci.kepler_mean.low << ", " << ci.kepler_mean.high << "], median ["
+                        << ci.kepler_median.low << ", " << ci.kepler_median.high << "]";
+            LOG_S(INFO) << "    Secondary mass mean [" << ci.sec_mean.low << ", " << ci.sec_mean.high << "], median ["
+                        << ci.sec_median.low << ", " << ci.sec_median.high << "]";
+            LOG_S(INFO) << "    Regression slope [" << ci.regression_slope.low << ", " << ci.regression_slope.high << "], mass ["
+                        << 1 / ci.regression_slope.high << ", " << 1 / ci.regression_slope.low << "]";
+        }
+
+        if (iMonteCarloTrials > 0)
+        {
+            std::vector<double> perigee, apogee, period;
+
+            satellite_database.view_perigees().copy_to(perigee);
+            satellite_database.view_apogees().copy_to(apogee);
+            satellite_database.view_periods().copy_to(period);
+
+            MonteCarloEngine monte_carlo(worker_pool, iMonteCarloTrials, uncertaintyModel, static_cast<uint64_t>(program.get<int>("--mc-seed")));
+            ecm_uncertainty_t uncertainty = monte_carlo.run(perigee.data(), apogee.data(), period.data(), perigee.size());
+
+            LOG_S(INFO) << "Input uncertainty (" << iMonteCarloTrials << " Monte Carlo trials, " << program.get<string>("--mc-model") << " errors):";
+
+            for (auto& [name, spread] : {std::make_pair("Kepler mass mean", uncertainty.kepler_mean),
+                                         std::make_pair("Secondary mass mean", uncertainty.sec_mean),
+                                         std::make_pair("Regression mass", uncertainty.regression_mass)})
+            {
+                // How much of the distance from the literature value the input errors alone can move the estimate.
+                double share = spread.std_dev / std::fabs(spread.nominal - LITERATURE_VALUE) * 100;
+
+                LOG_S(INFO) << "    " << name << ": nominal " << spread.nominal << ", std dev " << spread.std_dev
+                            << " (" << share << "% of its error), range [" << spread.min << ", " << spread.max << "]";
+            }
+        }
+
         LOG_S(INFO) << "Data saved to " << sOutputFile << ".";
     }
 
@@ -0,0 +1,31 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCS_COLUMN_SET_T_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCS_COLUMN_SET_T_H
+
+#include <cstdint>
+
+/**
+ * Set of UCS database input columns, one bit per column. The numeric columns use bits 1 to 7,
+ * in the order UCSSatelliteColumns parses them (longitude first, launch mass last); the other
+ * categorical columns follow the orbit class at bits 8 to 11.
+ */
+typedef uint32_t ucs_column_set_t;
+
+const ucs_column_set_t UCS_COLUMN_ORBIT_CLASS = 1u << 0;
+const ucs_column_set_t UCS_COLUMN_LONGITUDE = 1u << 1;
+const ucs_column_set_t UCS_COLUMN_PERIGEE = 1u << 2;
+const ucs_column_set_t UCS_COLUMN_APOGEE = 1u << 3;
+const ucs_column_set_t UCS_COLUMN_ECCENTRICITY = 1u << 4;
+const ucs_column_set_t UCS_COLUMN_INCLINATION = 1u << 5;
+const ucs_column_set_t UCS_COLUMN_PERIOD = 1u << 6;
+const ucs_column_set_t UCS_COLUMN_LAUNCH_MASS = 1u << 7;
+const ucs_column_set_t UCS_COLUMN_COUNTRY = 1u << 8;
+const ucs_column_set_t UCS_COLUMN_OPERATOR = 1u << 9;
+const ucs_column_set_t UCS_COLUMN_USERS = 1u << 10;
+const ucs_column_set_t UCS_COLUMN_PURPOSE = 1u << 11;
+
+const ucs_column_set_t UCS_COLUMNS_ALL = 0xfff;
+
+/** Columns read by the qualification rule and the Kepler / secondary-method kernels. */
+const ucs_column_set_t UCS_COLUMNS_KEPLER_ANALYSIS = UCS_COLUMN_PERIGEE | UCS_COLUMN_APOGEE | UCS_COLUMN_ECCENTRICITY | UCS_COLUMN_PERIOD;
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCS_COLUMN_SET_T_H
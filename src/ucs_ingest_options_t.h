@@ -0,0 +1,22 @@
+#ifndef CPP_SATELLITE_ANALYZER_PROJECT_UCS_INGEST_OPTIONS_T_H
+#define CPP_SATELLITE_ANALYZER_PROJECT_UCS_INGEST_OPTIONS_T_H
+
+#include <string>
+#include "ucs_column_set_t.h"
+
+class ThreadPool;
+
+/**
+ * Holds the settings that control how UCSSatelliteDatabase reads its input file.
+ */
+struct ucs_ingest_options_t {
+    bool memory_mapped = false; /*!< Tokenize the file in place through a read-only mapping instead of csv.h */
+    bool sanitize = false; /*!< Run the UCSSanitizer stage on raw lines (implies memory_mapped) */
+    std::string sanitized_output_path; /*!< Where the sanitizer writes its sanitized copy (empty for none) */
+    bool chunked = false; /*!< Split each input into chunks that are parsed concurrently on pool (implies memory_mapped) */
+    ThreadPool* pool = nullptr; /*!< Workers for chunked parsing and for parsing several inputs at once (nullptr for none) */
+    std::string cache_path; /*!< Binary column snapshot to load from, or to write after parsing (empty for none; numbered per input when there are several) */
+    ucs_column_set_t columns = UCS_COLUMNS_ALL; /*!< Input columns to convert while parsing; the rest are validated only (ignored with a cache_path, whose snapshots hold every column) */
+};
+
+#endif //CPP_SATELLITE_ANALYZER_PROJECT_UCS_INGEST_OPTIONS_T_H